@@ -0,0 +1,48 @@
+#include "benchmark/benchmark.h"
+#include <cstdlib>
+#include <new>
+
+#include "counters.hpp"
+std::atomic<size_t> Allocations::count(0);
+
+// count every allocation of the process, the array and nothrow variants forward to these
+// none of them is inlined, so the compiler does not pair malloc and free with new and delete expressions
+[[gnu::noinline]] void* operator new(size_t size) {
+    ++Allocations::count;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+#include "core/storage_bench.cpp"
+#include "core/layers/layer_bench.cpp"
+#include "core/graphics/buffer_bench.cpp"
+#include "core/graphics/batch_bench.cpp"
+#include "app/camera_bench.cpp"
+#include "app/layers/map_bench.cpp"
+
+#include "core/graphics/common.hpp"
+#include "core/window.hpp"
+#include "platform/context.hpp"
+
+int main(int argc, char** argv) {
+    // the graphics benchmarks share one context, which has to outlive all OpenGL objects
+    auto context = tme::platform::Context::create();
+    tme::core::Log::init();
+    auto window = tme::core::Storage<tme::core::Window>::global()->add(tme::core::Window::create(tme::core::Window::Data(nullptr, "tme-bench", 640, 480, false)))->getId();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    tme::app::graphics::FrameTable::global().clear();
+    tme::core::graphics::cleanUp();
+    tme::core::Storage<tme::core::Window>::global()->destroy(window);
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "counters.hpp"
+#include "app/camera.hpp"
+
+namespace tme {
+    namespace app {
+
+        static void BM_CameraMVP(benchmark::State& state) {
+            Camera camera(256, 256, 1920, 1080);
+            camera.scaleWidth(0.5);
+            camera.addX(16.0);
+            OpCounters counters(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(camera.getMVP());
+            }
+        }
+        BENCHMARK(BM_CameraMVP);
+
+    }
+}
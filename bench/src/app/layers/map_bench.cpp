@@ -0,0 +1,74 @@
+#include "counters.hpp"
+#include <cmath>
+#include <vector>
+#include "core/events/window.hpp"
+#include "core/graphics/renderqueue.hpp"
+#include "core/graphics/texture.hpp"
+#include "app/graphics/frames.hpp"
+#include "app/graphics/texture.hpp"
+#include "app/layers/map.hpp"
+
+namespace tme {
+    namespace app {
+        namespace layers {
+
+            // different animations, tiles of the same animation share a kind
+            static constexpr size_t s_animationCount = 4;
+
+            // arguments: number of animated tiles, animated on the CPU instead of the shader
+            static void BM_MapLayerUpdate(benchmark::State& state) {
+                size_t tileCount = static_cast<size_t>(state.range(0));
+                bool animatedOnCpu = state.range(1) != 0;
+
+                // tiles do not fit into a full FrameTable and fall back to the Animator
+                std::vector<core::graphics::Buffer::Space> reserved;
+                if (animatedOnCpu) {
+                    graphics::TextureTile::Frames frame{{1.0, {0.0f, 0.0f, 1.0f, 1.0f}}};
+                    for (auto space = graphics::FrameTable::global().add(frame, {}); space.offset != core::graphics::INVALID_OFFSET;
+                            space = graphics::FrameTable::global().add(frame, {})) {
+                        reserved.push_back(space);
+                    }
+                }
+
+                auto texture = core::Storage<core::graphics::Texture>::global()->create(16, 16);
+                std::vector<core::Handle<graphics::TextureTileFactory>> factories;
+                for (size_t i = 0; i < s_animationCount; ++i) {
+                    factories.push_back(core::Handle<graphics::TextureTileFactory>(new graphics::TextureTileFactory(texture->getId())));
+                    double frameTime = 0.05 * static_cast<double>(i + 1);
+                    factories.back()->addFrame({frameTime, {0.0f, 0.0f, 0.5f, 1.0f}});
+                    factories.back()->addFrame({frameTime, {0.5f, 0.0f, 1.0f, 1.0f}});
+                }
+
+                uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(tileCount))));
+                auto cursor = core::Handle<Cursor>(new Cursor());
+                auto viewport = core::Handle<Viewport>(new Viewport{0, 0, side, side});
+                MapLayer layer(0, side, side, cursor, viewport, core::Handle<core::graphics::RenderQueue>(new core::graphics::RenderQueue()));
+
+                // place the tiles the way the editor does
+                cursor->inBounds = true;
+                cursor->placeTile = true;
+                for (size_t i = 0; i < tileCount; ++i) {
+                    cursor->tileFactory = factories[i % s_animationCount];
+                    cursor->tileFactory->setPosition(static_cast<uint32_t>(i % side), static_cast<uint32_t>(i / side));
+                    core::events::WindowUpdate place(0.0);
+                    layer.onEvent(place);
+                }
+                cursor->placeTile = false;
+
+                OpCounters counters(state);
+                for (auto _ : state) {
+                    core::events::WindowUpdate update(1.0 / 60.0);
+                    layer.onEvent(update);
+                }
+                state.counters["tiles"] = static_cast<double>(layer.getTiles().getCount());
+
+                for (const auto& space : reserved) {
+                    graphics::FrameTable::global().remove(space);
+                }
+                core::Storage<core::graphics::Texture>::global()->destroy(texture->getId());
+            }
+            BENCHMARK(BM_MapLayerUpdate)->ArgsProduct({{1024, 16384, 262144}, {0, 1}});
+
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "counters.hpp"
+#include <vector>
+#include "core/graphics/batch.hpp"
+#include "core/graphics/vertex.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            // quad with two floats of position and two of texture coordinates per vertex
+            class _BenchQuad final : public Batchable {
+                Identifier m_id;
+                bool m_instanced;
+                float m_vertices[16];
+                unsigned int m_indices[6];
+
+                static Identifier layout() {
+                    static Identifier layoutId = 0;
+                    if (!Storage<VertexLayout>::global()->has(layoutId)) {
+                        auto created = Storage<VertexLayout>::global()->create();
+                        created->push<float>(2);
+                        created->push<float>(2);
+                        layoutId = created->getId();
+                    }
+                    return layoutId;
+                }
+
+                public:
+                _BenchQuad(bool instanced) : m_id(uuid<_BenchQuad>()), m_instanced(instanced), m_vertices(), m_indices{0, 1, 2, 2, 3, 0} {}
+
+                Batch::Config getBatchConfig() const override {
+                    // instanced quads store a single vertex per instance
+                    Batch::Config::Vertex vertex(m_instanced ? 1 : 4, sizeof(float) * 4, layout());
+                    Batch::Config::Index index(1, sizeof(m_indices), 6);
+                    return Batch::Config(vertex, index, [](Identifier, Identifier){}, 0, NO_TEXTURE, m_instanced);
+                }
+
+                const void* getVertexData() const override { return m_vertices; }
+                const void* getIndexData() const override { return m_indices; }
+                void setIndexOffset(unsigned int) override {}
+                Identifier getId() const override { return m_id; }
+            };
+
+            // batcher holding the amount of quads given by the first argument, instanced if the second one is set
+            static std::vector<Handle<Batchable>> fillBatcher(Batcher& batcher, const benchmark::State& state) {
+                std::vector<Handle<Batchable>> quads;
+                for (int64_t i = 0; i < state.range(0); ++i) {
+                    quads.push_back(Handle<Batchable>(new _BenchQuad(state.range(1) != 0)));
+                    batcher.set(*quads.back());
+                }
+                return quads;
+            }
+
+            static void BM_BatcherSet(benchmark::State& state) {
+                Batcher batcher(64);
+                auto quads = fillBatcher(batcher, state);
+                size_t next = 0;
+                OpCounters counters(state);
+                for (auto _ : state) {
+                    // objects which are already set are updated in place
+                    batcher.set(*quads[next]);
+                    next = (next + 1) % quads.size();
+                }
+            }
+            BENCHMARK(BM_BatcherSet)->ArgsProduct({{256, 4096, 32768}, {0, 1}});
+
+            static void BM_BatcherUnsetSet(benchmark::State& state) {
+                Batcher batcher(64);
+                auto quads = fillBatcher(batcher, state);
+                size_t next = 0;
+                OpCounters counters(state);
+                for (auto _ : state) {
+                    batcher.unset(*quads[next]);
+                    batcher.set(*quads[next]);
+                    next = (next + 1) % quads.size();
+                }
+            }
+            BENCHMARK(BM_BatcherUnsetSet)->ArgsProduct({{256, 4096, 32768}, {0, 1}});
+
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#include "counters.hpp"
+#include <random>
+#include <vector>
+#include "core/graphics/buffer.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            // churn operations between two flushes of a streaming buffer, roughly the edits of a frame
+            static constexpr int64_t s_opsPerFrame = 64;
+            // largest amount of entries added at once
+            static constexpr GLsizeiptr s_maxSpaceSize = 8;
+
+            // arguments: number of live spaces, streaming mode
+            static void BM_BufferChurn(benchmark::State& state) {
+                GLsizeiptr spaceCount = static_cast<GLsizeiptr>(state.range(0));
+                bool streaming = state.range(1) != 0;
+                // half of the buffer stays free, so adds never fail
+                Buffer buffer(GL_ARRAY_BUFFER, sizeof(float), spaceCount * s_maxSpaceSize * 2, streaming);
+                std::vector<float> data(s_maxSpaceSize, 1.0f);
+                std::mt19937 random(42);
+                std::uniform_int_distribution<GLsizeiptr> sizes(1, s_maxSpaceSize);
+                std::vector<Buffer::Space> spaces;
+                for (GLsizeiptr i = 0; i < spaceCount; ++i) {
+                    spaces.push_back(buffer.add(sizes(random), data.data()));
+                }
+                buffer.flush();
+                std::uniform_int_distribution<size_t> picks(0, spaces.size() - 1);
+
+                int64_t ops = 0;
+                OpCounters counters(state);
+                for (auto _ : state) {
+                    // remove a random space and add one of another size in its place
+                    auto& space = spaces[picks(random)];
+                    // a fragmented buffer may not have had room for the last add
+                    if (space.offset != INVALID_OFFSET) {
+                        buffer.remove(space);
+                    }
+                    space = buffer.add(sizes(random), data.data());
+                    if (streaming && ++ops % s_opsPerFrame == 0) {
+                        buffer.flush();
+                    }
+                }
+                state.counters["free spaces"] = static_cast<double>(buffer.getFreeSpaceCount());
+            }
+            BENCHMARK(BM_BufferChurn)->ArgsProduct({{256, 4096, 65536}, {0, 1}});
+
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#include "counters.hpp"
+#include "core/events/dispatcher.hpp"
+#include "core/events/window.hpp"
+#include "core/layers/layer.hpp"
+
+namespace tme {
+    namespace core {
+        namespace layers {
+
+            // layer handling updates without consuming them, like the layers of a Tilemap
+            class _BenchLayer final : public Layer, public events::Dispatcher<_BenchLayer> {
+                double m_time;
+
+                public:
+                _BenchLayer() : Layer("_BenchLayer"), Dispatcher(this), m_time(0.0) {}
+
+                void render() override {}
+
+                void onEvent(events::Event& event) override {
+                    dispatchEvent<events::WindowUpdate>(event, &_BenchLayer::handleWindowUpdate);
+                }
+
+                bool handleWindowUpdate(events::WindowUpdate& event) {
+                    m_time += event.getDeltaTime();
+                    benchmark::DoNotOptimize(m_time);
+                    return false;
+                }
+            };
+
+            // argument: number of layers on the Stack
+            static void BM_StackDispatch(benchmark::State& state) {
+                Stack stack;
+                for (int64_t i = 0; i < state.range(0); ++i) {
+                    stack.push<_BenchLayer>();
+                }
+                OpCounters counters(state);
+                for (auto _ : state) {
+                    events::WindowUpdate event(1.0 / 60.0);
+                    stack.onEvent(event);
+                }
+            }
+            BENCHMARK(BM_StackDispatch)->RangeMultiplier(4)->Range(1, 64);
+
+        }
+    }
+}
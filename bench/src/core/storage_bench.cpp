@@ -0,0 +1,61 @@
+#include "counters.hpp"
+#include <vector>
+#include "core/storage.hpp"
+
+namespace tme {
+    namespace core {
+
+        class _BenchMappable : public Mappable {
+            Identifier m_id;
+
+            public:
+            _BenchMappable() : m_id(uuid<_BenchMappable>()) {}
+            Identifier getId() const override { return m_id; }
+        };
+
+        // storage holding the amount of elements given by the first argument
+        static std::vector<Identifier> fillStorage(Storage<_BenchMappable>& storage, const benchmark::State& state) {
+            std::vector<Identifier> ids;
+            for (int64_t i = 0; i < state.range(0); ++i) {
+                ids.push_back(storage.create()->getId());
+            }
+            return ids;
+        }
+
+        static void BM_StorageCreate(benchmark::State& state) {
+            auto storage = Storage<_BenchMappable>::localInstance();
+            fillStorage(*storage, state);
+            OpCounters counters(state);
+            for (auto _ : state) {
+                // destroyed again to keep the size of the storage constant
+                storage->destroy(storage->create()->getId());
+            }
+        }
+        BENCHMARK(BM_StorageCreate)->RangeMultiplier(8)->Range(64, 32768);
+
+        static void BM_StorageGet(benchmark::State& state) {
+            auto storage = Storage<_BenchMappable>::localInstance();
+            auto ids = fillStorage(*storage, state);
+            size_t next = 0;
+            OpCounters counters(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(storage->get(ids[next]));
+                next = (next + 1) % ids.size();
+            }
+        }
+        BENCHMARK(BM_StorageGet)->RangeMultiplier(8)->Range(64, 32768);
+
+        static void BM_StorageHas(benchmark::State& state) {
+            auto storage = Storage<_BenchMappable>::localInstance();
+            auto ids = fillStorage(*storage, state);
+            size_t next = 0;
+            OpCounters counters(state);
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(storage->has(ids[next]));
+                next = (next + 1) % ids.size();
+            }
+        }
+        BENCHMARK(BM_StorageHas)->RangeMultiplier(8)->Range(64, 32768);
+
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef _BENCH_COUNTERS_H
+#define _BENCH_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include "benchmark/benchmark.h"
+#include "core/graphics/state.hpp"
+
+/**//**
+ * \brief Heap allocations of the process, counted by the global operator new of main_bench.cpp.
+ */
+struct Allocations {
+    /// number of allocations since the start of the process
+    static std::atomic<size_t> count;
+};
+
+/**//**
+ * \brief Reports allocations and uploaded bytes per iteration of a benchmark.
+ *
+ * Counts from construction to destruction, so it should be declared right before the benchmark
+ * loop, after all setup. Objects declared before it are destroyed after the report.
+ */
+class OpCounters {
+    benchmark::State& m_state;
+    size_t m_allocations;
+
+    public:
+    OpCounters(benchmark::State& state) : m_state(state), m_allocations(Allocations::count.load()) {
+        tme::core::graphics::State::global().resetCounters();
+    }
+
+    ~OpCounters() {
+        size_t allocations = Allocations::count.load() - m_allocations;
+        size_t uploaded = tme::core::graphics::State::global().getUploadedBytes();
+        m_state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+        m_state.counters["uploaded/op"] = benchmark::Counter(static_cast<double>(uploaded), benchmark::Counter::kAvgIterations, benchmark::Counter::OneK::kIs1024);
+    }
+};
+
+#endif
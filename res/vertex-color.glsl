@@ -1,6 +1,6 @@
 #version 330 core
 
-layout(location = 0) in vec4 position;
+layout(location = 0) in vec2 position;
 layout(location = 1) in vec4 vertexColor;
 
 uniform mat4 u_mvp;
@@ -9,9 +9,14 @@ out vec4 v_color;
 
 void main()
 {
-    gl_Position = u_mvp * position;
+    // corners of the tile in the order of the shared tile index
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = u_mvp * vec4(position + corner, 0.0, 1.0);
     gl_Position.z = 0.0;
     gl_Position.w = 1.0;
+    // instances of removed tiles are cleared, collapse them
+    if (vertexColor == vec4(0.0)) {
+        gl_Position = vec4(0.0);
+    }
     v_color = vertexColor;
 };
-
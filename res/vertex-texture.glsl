@@ -1,17 +1,43 @@
 #version 330 core
 
-layout(location = 0) in vec4 position;
-layout(location = 1) in vec2 texturePosition;
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 texturePosition;
+layout(location = 2) in vec2 animation;
 
 uniform mat4 u_mvp;
+uniform float u_time;
+
+// two entries per frame: texture position and timing (end of the frame in the cycle, frame count, cycle duration)
+layout(std140) uniform Frames
+{
+    vec4 u_frames[1024];
+};
 
 out vec2 v2_texturePosition;
 
 void main()
 {
-    gl_Position = u_mvp * position;
+    // corners of the tile in the order of the shared tile index
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = u_mvp * vec4(position + corner, 0.0, 1.0);
     gl_Position.z = 0.0;
     gl_Position.w = 1.0;
-    v2_texturePosition = texturePosition;
+    // instances of removed tiles are cleared, collapse them
+    if (texturePosition.xy == texturePosition.zw) {
+        gl_Position = vec4(0.0);
+    }
+    vec4 frame = texturePosition;
+    // animation.x is the first frame in the table, negative if the tile is not animated by the shader
+    if (animation.x >= 0.0) {
+        int first = int(animation.x);
+        vec4 timing = u_frames[2 * first + 1];
+        int count = int(timing.y);
+        float time = timing.z > 0.0 ? mod(u_time - animation.y, timing.z) : 0.0;
+        int current = 0;
+        while (current < count - 1 && time >= u_frames[2 * (first + current) + 1].x) {
+            ++current;
+        }
+        frame = u_frames[2 * (first + current)];
+    }
+    v2_texturePosition = mix(frame.xy, frame.zw, corner);
 };
-
@@ -0,0 +1,80 @@
+/** @file */
+
+#include "app/animator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <sstream>
+
+namespace tme {
+    namespace app {
+
+        Animator::Animator() : m_time(0.0), m_queue(), m_scheduled(), m_changed(), m_changedKinds() {
+            TME_INFO("created {}", *this);
+        }
+
+        Animator::~Animator() {
+            TME_INFO("deleting {}", *this);
+        }
+
+        void Animator::add(TileGrid::Kind kind, const graphics::Tile& prototype) {
+            if (kind >= m_scheduled.size()) {
+                m_scheduled.resize(kind + 1u, false);
+                m_changed.resize(kind + 1u, false);
+            }
+            if (m_scheduled[kind] || !prototype.isAnimated()) {
+                return;
+            }
+            double step = prototype.getNextUpdate();
+            if (std::isinf(step)) {
+                return;
+            }
+            m_scheduled[kind] = true;
+            m_queue.push_back({m_time + std::max(step, 0.0), step, kind});
+            std::push_heap(m_queue.begin(), m_queue.end(), std::greater<Event>());
+        }
+
+        const std::vector<TileGrid::Kind>& Animator::update(double deltaTime, const TileGrid& grid) {
+            for (auto kind : m_changedKinds) {
+                m_changed[kind] = false;
+            }
+            m_changedKinds.clear();
+            m_time += deltaTime;
+            while (!m_queue.empty() && m_queue.front().time <= m_time) {
+                std::pop_heap(m_queue.begin(), m_queue.end(), std::greater<Event>());
+                Event event = m_queue.back();
+                m_queue.pop_back();
+
+                if (!grid.hasAnimatedCells(event.kind)) {
+                    // the last tile of the kind has been removed
+                    m_scheduled[event.kind] = false;
+                    continue;
+                }
+                auto prototype = grid.getPrototype(event.kind);
+                if (prototype->update(std::max(event.step, 0.0)) && !m_changed[event.kind]) {
+                    m_changed[event.kind] = true;
+                    m_changedKinds.push_back(event.kind);
+                }
+
+                double step = prototype->getNextUpdate();
+                if (std::isinf(step)) {
+                    m_scheduled[event.kind] = false;
+                    continue;
+                }
+                // frames without duration advance once per update
+                double time = step > 0.0 ? event.time + step : std::nextafter(m_time, std::numeric_limits<double>::infinity());
+                m_queue.push_back({time, step, event.kind});
+                std::push_heap(m_queue.begin(), m_queue.end(), std::greater<Event>());
+            }
+            return m_changedKinds;
+        }
+
+        std::string Animator::toString() const {
+            std::stringstream ss;
+            ss << "Animator(" << m_time << ',' << m_queue.size() << ')';
+            return ss.str();
+        }
+
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef _APP_ANIMATOR_H
+#define _APP_ANIMATOR_H
+/** @file */
+
+#include <vector>
+#include "core/loggable.hpp"
+#include "app/tilegrid.hpp"
+
+namespace tme {
+    namespace app {
+
+        /**//**
+         * \brief Scheduler advancing the animations of the tile kinds of a TileGrid.
+         *
+         * All tiles of a kind share the animation state of the kind's prototype, so an animation
+         * advances once for all of them. Animated kinds are kept in a min-heap ordered by the time
+         * of their next change, an update only touches the kinds which are due. Kinds without tiles left
+         * in the grid are dropped once they are due instead of being advanced, add() schedules them again.
+         */
+        class Animator final : public core::Loggable {
+            struct Event {
+                // point in time the kind changes
+                double time;
+                // time passed to Tile::update
+                double step;
+                TileGrid::Kind kind;
+
+                bool operator>(const Event& other) const { return time > other.time; }
+            };
+
+            double m_time;
+            // min-heap of the next change of every scheduled kind
+            std::vector<Event> m_queue;
+            std::vector<bool> m_scheduled;
+            std::vector<bool> m_changed;
+            std::vector<TileGrid::Kind> m_changedKinds;
+
+            public:
+            /**//**
+             * \brief Construct Animator without scheduled kinds.
+             */
+            Animator();
+            ~Animator();
+
+            /**//**
+             * \brief Schedule the animation of a kind.
+             *
+             * Kinds which are already scheduled or not animated are ignored.
+             * Has to be called again once tiles of a kind are placed after its last tile has been removed.
+             *
+             * @param kind kind as returned by TileGrid::addKind()
+             * @param prototype the prototype Tile of the kind
+             */
+            void add(TileGrid::Kind kind, const graphics::Tile& prototype);
+
+            /**//**
+             * \brief Advance time and update all due kinds.
+             *
+             * @param deltaTime time passed since the last update in seconds
+             * @param grid the TileGrid providing the prototypes of the scheduled kinds
+             *
+             * @return kinds which changed, each kind is contained at most once
+             */
+            const std::vector<TileGrid::Kind>& update(double deltaTime, const TileGrid& grid);
+
+            /**//**
+             * \brief Get number of scheduled kinds.
+             *
+             * @return number of animated kinds
+             */
+            inline size_t getScheduledCount() const { return m_queue.size(); }
+
+            std::string toString() const override;
+        };
+
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+/** @file */
+
+#include "app/chunkloader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace tme {
+    namespace app {
+
+        ChunkLoader::ChunkLoader(const std::string& filePath)
+            : m_file(std::make_unique<MapFile>(filePath)),
+            m_requests(s_queueSize),
+            m_results(s_queueSize),
+            m_running(true),
+            m_mutex(),
+            m_wakeUp(),
+            m_worker(&ChunkLoader::run, this) {
+            TME_INFO("created {}", *this);
+        }
+
+        ChunkLoader::~ChunkLoader() {
+            TME_INFO("deleting {}", *this);
+            m_running = false;
+            m_wakeUp.notify_one();
+            m_worker.join();
+        }
+
+        bool ChunkLoader::request(size_t layer, size_t index) {
+            Request request{layer, index};
+            if (!m_requests.push(request)) {
+                return false;
+            }
+            m_wakeUp.notify_one();
+            return true;
+        }
+
+        bool ChunkLoader::poll(Chunk& chunk) {
+            return m_results.pop(chunk);
+        }
+
+        TileGrid::Chunk ChunkLoader::read(size_t layer, size_t index) const {
+            const auto& header = m_file->getHeader();
+            uint32_t chunksX = header.width / header.chunkSize + (header.width % header.chunkSize != 0);
+            const TileGrid::Kind* kinds = m_file->getChunk(layer, static_cast<uint32_t>(index % chunksX), static_cast<uint32_t>(index / chunksX));
+            size_t size = static_cast<size_t>(header.chunkSize) * header.chunkSize;
+            if (std::all_of(kinds, kinds + size, [](TileGrid::Kind kind) { return kind == TileGrid::EMPTY; })) {
+                return nullptr;
+            }
+            TileGrid::Chunk chunk(new TileGrid::Kind[size]);
+            std::copy(kinds, kinds + size, chunk.get());
+            return chunk;
+        }
+
+        void ChunkLoader::run() {
+            Request request;
+            while (m_running) {
+                if (!m_requests.pop(request)) {
+                    // requests are pushed without the lock, so a notification may be missed and the wait is bounded
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wakeUp.wait_for(lock, std::chrono::milliseconds(5), [this]() { return !m_running || !m_requests.empty(); });
+                    continue;
+                }
+                Chunk chunk{request.layer, request.index, read(request.layer, request.index)};
+                // the render thread consumes the results every frame
+                while (m_running && !m_results.push(chunk)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        std::string ChunkLoader::toString() const {
+            std::stringstream ss;
+            ss << "ChunkLoader(" << *m_file << ')';
+            return ss.str();
+        }
+
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef _APP_CHUNKLOADER_H
+#define _APP_CHUNKLOADER_H
+/** @file */
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "core/loggable.hpp"
+#include "core/queue.hpp"
+#include "app/mapfile.hpp"
+#include "app/tilegrid.hpp"
+
+namespace tme {
+    namespace app {
+
+        /**//**
+         * \brief Background loader for the chunks of a tilemap file.
+         *
+         * Owns the mapped MapFile and a worker thread. Chunks are requested by the render thread,
+         * the worker copies them out of the mapping, so page faults of the file hit the worker instead
+         * of the render thread, and hands them back as ready TileGrid chunks.
+         * Requests and results are exchanged through lock-free queues, the render thread never blocks on the worker.
+         * The chunks of the file have to be of the same size as the chunks of the TileGrid they are loaded into.
+         */
+        class ChunkLoader final : public core::Loggable {
+            public:
+            /**//**
+             * \brief A loaded chunk.
+             */
+            struct Chunk {
+                /// index of the layer in the file
+                size_t layer = 0;
+                /// row major index of the chunk inside the layer
+                size_t index = 0;
+                /// kinds of the chunk, nullptr if the chunk has no tiles
+                TileGrid::Chunk kinds;
+            };
+
+            private:
+            struct Request {
+                size_t layer = 0;
+                size_t index = 0;
+            };
+
+            // maximum number of requests and results in flight
+            static constexpr size_t s_queueSize = 256;
+
+            std::unique_ptr<MapFile> m_file;
+            core::SpscQueue<Request> m_requests;
+            core::SpscQueue<Chunk> m_results;
+            std::atomic<bool> m_running;
+            // only used to let the worker sleep while there are no requests
+            std::mutex m_mutex;
+            std::condition_variable m_wakeUp;
+            std::thread m_worker;
+
+            public:
+            /**//**
+             * \brief Map a tilemap file and start the worker.
+             *
+             * @param filePath path to the tilemap file
+             *
+             * @throw InvalidInput when the file can not be mapped
+             */
+            ChunkLoader(const std::string& filePath);
+            ~ChunkLoader();
+
+            /**//**
+             * \brief Get the mapped file.
+             *
+             * @return reference to the MapFile
+             */
+            inline const MapFile& getFile() const { return *m_file; }
+
+            /**//**
+             * \brief Request a chunk to be loaded in the background.
+             *
+             * Has to be called by the thread calling poll().
+             *
+             * @param layer index of the layer in the file
+             * @param index row major index of the chunk
+             *
+             * @return true if the request has been queued, false if too many requests are in flight
+             */
+            bool request(size_t layer, size_t index);
+            /**//**
+             * \brief Take a loaded chunk.
+             *
+             * Chunks are returned in the order they have been requested.
+             *
+             * @param chunk receives the loaded chunk
+             *
+             * @return true if a chunk has been taken, false if no chunk is ready
+             */
+            bool poll(Chunk& chunk);
+            /**//**
+             * \brief Load a chunk immediately on the calling thread.
+             *
+             * @param layer index of the layer in the file
+             * @param index row major index of the chunk
+             *
+             * @return kinds of the chunk, nullptr if the chunk has no tiles
+             */
+            TileGrid::Chunk read(size_t layer, size_t index) const;
+
+            std::string toString() const override;
+
+            private:
+            void run();
+        };
+
+    }
+}
+
+#endif
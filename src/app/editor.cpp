@@ -4,10 +4,12 @@
 #include "core/graphics/common.hpp"
 #include "core/layers/imgui.hpp"
 #include "core/layers/layer.hpp"
+#include "core/layers/profiler.hpp"
 #include "core/storage.hpp"
 #include "app/layers/ui.hpp"
 #include "app/layers/editing.hpp"
 #include "app/layers/menu.hpp"
+#include "app/graphics/frames.hpp"
 
 namespace tme {
     namespace app {
@@ -18,6 +20,7 @@ namespace tme {
 
         Editor::~Editor() {
             core::Storage<Tilemap>::global()->clear();
+            graphics::FrameTable::global().clear();
             core::graphics::cleanUp();
         }
 
@@ -42,6 +45,7 @@ namespace tme {
                 m_layers.push<layers::EditingUI>(m_tilemap);
             }
             m_layers.push<layers::MenuBar>(getId());
+            m_layers.push<core::layers::ProfilerOverlay>();
             m_layers.push<core::layers::Imgui>();
             m_reconstruct = false;
         }
@@ -37,6 +37,12 @@ namespace tme {
              * @param tilemap Handle to the new Tilemap which should be edited
              */
             void setTilemap(core::Handle<Tilemap> tilemap);
+            /**//**
+             * \brief Get the Tilemap being edited.
+             *
+             * @return Handle to the Tilemap, nullptr if there is none
+             */
+            inline core::Handle<Tilemap> getTilemap() const { return m_tilemap; }
 
             private:
             void constructLayers();
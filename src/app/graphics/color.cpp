@@ -1,5 +1,7 @@
 /** @file */
 #include "app/graphics/color.hpp"
+#include <cstring>
+#include <functional>
 #include <sstream>
 #include "core/storage.hpp"
 #include "core/graphics/shader.hpp"
@@ -9,14 +11,8 @@ namespace tme {
         namespace graphics {
 
             ColorTile::ColorTile(core::Identifier id, uint32_t x, uint32_t y, core::Identifier shaderId, glm::vec4 color)
-                : Tile(id, x, y, shaderId) {
-                float xf = static_cast<float>(x);
-                float yf = static_cast<float>(y);
-                m_verticies[0] = {{0.0f + xf, 0.0f + yf}, {color.r, color.g, color.b, color.a}};
-                m_verticies[1] = {{1.0f + xf, 0.0f + yf}, {color.r, color.g, color.b, color.a}};
-                m_verticies[2] = {{0.0f + xf, 1.0f + yf}, {color.r, color.g, color.b, color.a}};
-                m_verticies[3] = {{1.0f + xf, 1.0f + yf}, {color.r, color.g, color.b, color.a}};
-            }
+                : Tile(id, x, y, shaderId),
+                  m_instance({{static_cast<float>(x), static_cast<float>(y)}, color}) {}
 
             core::Identifier ColorTile::createDefaultShader() {
                 auto globalShaderStages = core::Storage<core::graphics::Shader::Stage>::global();
@@ -29,15 +25,38 @@ namespace tme {
                  return shaderId;
             }
 
+            void ColorTile::setPosition(uint32_t x, uint32_t y) {
+                Tile::setPosition(x, y);
+                m_instance.pos = {static_cast<float>(x), static_cast<float>(y)};
+            }
+
+            bool ColorTile::matches(const Tile& other) const {
+                return Tile::matches(other) && static_cast<const ColorTile&>(other).m_instance.color == m_instance.color;
+            }
+
+            size_t ColorTile::hash() const {
+                size_t seed = Tile::hash();
+                for (int i = 0; i < 4; ++i) {
+                    seed = combineHash(seed, std::hash<float>{}(m_instance.color[i]));
+                }
+                return seed;
+            }
+
             const void* ColorTile::getVertexData() const {
-                return &m_verticies;
+                return &m_instance;
+            }
+
+            void ColorTile::writeVertexData(uint32_t x, uint32_t y, void* target) const {
+                Instance instance = m_instance;
+                instance.pos = {static_cast<float>(x), static_cast<float>(y)};
+                std::memcpy(target, &instance, sizeof(Instance));
             }
 
             core::graphics::Batch::Config::Vertex ColorTile::s_vertexConfig() {
                 auto vl = core::Storage<core::graphics::VertexLayout>::global()->create();
                 vl->push<float>(2);
                 vl->push<float>(4);
-                core::graphics::Batch::Config::Vertex vertexData(4, sizeof(Vertex), vl->getId());
+                core::graphics::Batch::Config::Vertex vertexData(1, sizeof(Instance), vl->getId());
                 return vertexData;
             }
 
@@ -15,15 +15,15 @@ namespace tme {
              * \brief Tile implementation for colored tiles.
              *
              * Should only be created with ColorTileFactory.
-             * All four vertices will have the same color.
+             * The whole tile has the same color.
              */
             class ColorTile final : public Tile {
-                struct Vertex {
+                struct Instance {
                     glm::vec2 pos;
                     glm::vec4 color;
                 };
 
-                Vertex m_verticies[4];
+                Instance m_instance;
 
                 static core::graphics::Batch::Config::Vertex s_vertexConfig();
 
@@ -31,14 +31,13 @@ namespace tme {
                 /**//**
                  * \brief Construct ColorTile.
                  *
-                 * Stores the color for every tile but sets all to the same color.
-                 * Could be used as a starting point to create a Tile with different colors on every vertex.
+                 * Stores position and color as per instance data.
                  *
                  * @param id identifier of the tile, should be provided by ColorTileFactory
                  * @param x position of the tile on x axis in full tiles
                  * @param y position of the tile on y axis in full tiles
                  * @param shaderId global Identifier of the Shader to be used
-                 * @param color color of all four vertices
+                 * @param color color of the tile
                  */
                 ColorTile(core::Identifier id, uint32_t x, uint32_t y, core::Identifier shaderId, glm::vec4 color);
                 ~ColorTile() = default;
@@ -52,8 +51,20 @@ namespace tme {
                  */
                 static core::Identifier createDefaultShader();
 
+                /**//**
+                 * \brief Get color of the tile.
+                 *
+                 * @return color of the whole tile
+                 */
+                inline glm::vec4 getColor() const { return m_instance.color; }
+
+                void setPosition(uint32_t x, uint32_t y) override;
+                bool matches(const Tile& other) const override;
+                size_t hash() const override;
+
                 core::graphics::Batch::Config getBatchConfig() const override;
                 const void* getVertexData() const override;
+                void writeVertexData(uint32_t x, uint32_t y, void* target) const override;
 
                 std::string toString() const override;
             };
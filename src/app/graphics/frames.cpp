@@ -0,0 +1,90 @@
+/** @file */
+#include "app/graphics/frames.hpp"
+#include <sstream>
+#include <vector>
+#include "core/graphics/state.hpp"
+
+namespace tme {
+    namespace app {
+        namespace graphics {
+
+            static_assert(sizeof(FrameTable::Entry) == 2 * sizeof(glm::vec4), "unexpected padding in FrameTable::Entry");
+
+            FrameTable::FrameTable() : m_buffer(nullptr), m_start(std::chrono::steady_clock::now()), m_time(0.0) {
+                TME_INFO("created {}", *this);
+            }
+
+            FrameTable::~FrameTable() {
+                TME_INFO("deleting {}", *this);
+            }
+
+            FrameTable& FrameTable::global() {
+                static FrameTable table;
+                return table;
+            }
+
+            core::graphics::Buffer::Space FrameTable::add(const TextureTile::Frames& frames, const core::graphics::Atlas::Region& region) {
+                create();
+                double cycle = 0.0;
+                for (const auto& frame : frames) {
+                    cycle += frame.time;
+                }
+                std::vector<Entry> entries;
+                entries.reserve(frames.size());
+                double end = 0.0;
+                for (const auto& frame : frames) {
+                    end += frame.time;
+                    entries.push_back({region.map(frame.texPos),
+                            glm::vec4(static_cast<float>(end), static_cast<float>(frames.size()), static_cast<float>(cycle), 0.0f)});
+                }
+                auto space = m_buffer->add(static_cast<GLsizeiptr>(entries.size()), entries.data());
+                if (space.offset == core::graphics::INVALID_OFFSET) {
+                    TME_WARN("frame table is full, animating {} frames on the CPU", frames.size());
+                }
+                return space;
+            }
+
+            void FrameTable::remove(const core::graphics::Buffer::Space& space) {
+                if (m_buffer) {
+                    m_buffer->remove(space);
+                }
+            }
+
+            void FrameTable::update() {
+                m_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+            }
+
+            void FrameTable::bind(core::graphics::Shader& shader) {
+                // the block has to be backed by a buffer even if no tile is animated
+                create();
+                shader.setUniformBlock("Frames", BINDING);
+                core::graphics::State::global().bindBufferBase(GL_UNIFORM_BUFFER, BINDING, static_cast<GLuint>(m_buffer->getId()));
+                // single precision keeps steps below 10ms for about a day
+                shader.setUniform1f("u_time", static_cast<float>(m_time));
+            }
+
+            void FrameTable::clear() {
+                m_buffer = nullptr;
+            }
+
+            void FrameTable::create() {
+                if (!m_buffer) {
+                    m_buffer = core::Handle<core::graphics::Buffer>(new core::graphics::Buffer(GL_UNIFORM_BUFFER, sizeof(Entry), CAPACITY));
+                }
+            }
+
+            std::string FrameTable::toString() const {
+                std::stringstream ss;
+                ss << "FrameTable(" << m_time << ',';
+                if (m_buffer) {
+                    ss << m_buffer->getFreeSpace();
+                } else {
+                    ss << CAPACITY;
+                }
+                ss << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
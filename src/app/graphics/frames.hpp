@@ -0,0 +1,119 @@
+#ifndef _APP_GRAPHICS_FRAMES_H
+#define _APP_GRAPHICS_FRAMES_H
+/** @file */
+
+#include <chrono>
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+#include "core/graphics/atlas.hpp"
+#include "core/graphics/buffer.hpp"
+#include "core/graphics/shader.hpp"
+#include "app/graphics/texture.hpp"
+#include "glm/vec4.hpp"
+
+namespace tme {
+    namespace app {
+        namespace graphics {
+
+            /**//**
+             * \brief Animation frames of all GPU animated TextureTile instances.
+             *
+             * The frames are stored in a uniform buffer read by the vertex-texture shader, which selects
+             * the current frame of every tile from the time of the table. Animations advance without any
+             * work on the CPU and without uploads, no matter how many tiles use them.
+             * The table holds CAPACITY frames, tiles whose animation does not fit are animated on the CPU.
+             */
+            class FrameTable final : public core::Loggable {
+                public:
+                /**//**
+                 * \brief Frame as stored in the uniform buffer.
+                 *
+                 * Matches two vec4 of the std140 layout of the Frames block of the shader.
+                 */
+                struct Entry {
+                    /// coordinates on the atlas page
+                    glm::vec4 texPos;
+                    /// end of the frame in the cycle in seconds, frame count and duration of the cycle in seconds
+                    glm::vec4 timing;
+                };
+
+                /// number of frames, 16KB is the minimum size of a uniform block every implementation supports
+                static constexpr GLsizeiptr CAPACITY = 512;
+                /// GL_UNIFORM_BUFFER binding point of the table
+                static constexpr GLuint BINDING = 0;
+
+                private:
+                // created with the first use as it requires a context
+                core::Handle<core::graphics::Buffer> m_buffer;
+                std::chrono::steady_clock::time_point m_start;
+                double m_time;
+
+                public:
+                /**//**
+                 * \brief Construct empty FrameTable starting at time 0.
+                 */
+                FrameTable();
+                ~FrameTable();
+
+                /**//**
+                 * \brief Get the FrameTable shared by all tiles.
+                 *
+                 * @return reference to the global FrameTable
+                 */
+                static FrameTable& global();
+
+                /**//**
+                 * \brief Add the frames of an animation.
+                 *
+                 * @param frames frames of the animation with coordinates on the original texture
+                 * @param region location of the texture on its atlas page
+                 *
+                 * @return Space of the frames, its offset is the index of the first frame used by the shader,
+                 * the offset is INVALID_OFFSET if the table is full
+                 */
+                core::graphics::Buffer::Space add(const TextureTile::Frames& frames, const core::graphics::Atlas::Region& region);
+                /**//**
+                 * \brief Remove the frames of an animation.
+                 *
+                 * @param space Space returned by add()
+                 */
+                void remove(const core::graphics::Buffer::Space& space);
+
+                /**//**
+                 * \brief Advance the time of the table to now.
+                 *
+                 * Should be called once per frame so all layers show the same frames.
+                 */
+                void update();
+                /**//**
+                 * \brief Get time of the table.
+                 *
+                 * @return seconds since the table has been created, as of the last update()
+                 */
+                inline double getTime() const { return m_time; }
+
+                /**//**
+                 * \brief Bind the table and set the time for a shader reading from it.
+                 *
+                 * @param shader the bound Shader with a Frames uniform block and a u_time uniform
+                 */
+                void bind(core::graphics::Shader& shader);
+
+                /**//**
+                 * \brief Delete the uniform buffer.
+                 *
+                 * Has to be called before the context is destroyed.
+                 */
+                void clear();
+
+                std::string toString() const override;
+
+                private:
+                void create();
+            };
+
+        }
+    }
+}
+
+#endif
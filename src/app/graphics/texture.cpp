@@ -1,10 +1,13 @@
 /** @file */
 #include "app/graphics/texture.hpp"
+#include <cstring>
+#include <functional>
 #include <sstream>
 #include "core/storage.hpp"
 #include "core/graphics/shader.hpp"
 #include "core/graphics/texture.hpp"
 #include "core/exceptions/input.hpp"
+#include "app/graphics/frames.hpp"
 
 namespace tme {
     namespace app {
@@ -13,18 +16,34 @@ namespace tme {
             TextureTile::TextureTile(core::Identifier id, uint32_t x, uint32_t y, core::Identifier shaderId, core::Identifier textureId, const Frames& frames)
                 : Tile(id, x, y, shaderId),
                   m_textureId(textureId),
+                  m_region(),
                   m_frames(frames),
-                  m_activeFrame(0) {
+                  m_activeFrame(0),
+                  m_animation({core::graphics::INVALID_OFFSET, 0}) {
                 if (frames.size() < 1) {
                    throw core::exceptions::InvalidInput("No frames for texture tile provided");
                 }
-                float xf = static_cast<float>(x);
-                float yf = static_cast<float>(y);
-                Frame frame = m_frames[m_activeFrame];
-                m_verticies[0] = {{0.0f + xf, 0.0f + yf}, {frame.texPos.x, frame.texPos.y}};
-                m_verticies[1] = {{1.0f + xf, 0.0f + yf}, {frame.texPos.z, frame.texPos.y}};
-                m_verticies[2] = {{0.0f + xf, 1.0f + yf}, {frame.texPos.x, frame.texPos.w}};
-                m_verticies[3] = {{1.0f + xf, 1.0f + yf}, {frame.texPos.z, frame.texPos.w}};
+                m_region.page = m_textureId;
+                auto globalTextures = core::Storage<core::graphics::Texture>::global();
+                if (globalTextures->has(m_textureId)) {
+                    if (auto region = core::graphics::Atlas::global().add(*globalTextures->get(m_textureId)); region) {
+                        m_region = *region;
+                    }
+                }
+                m_instance = {{static_cast<float>(x), static_cast<float>(y)}, m_region.map(m_frames[m_activeFrame].texPos), {-1.0f, 0.0f}};
+                if (m_frames.size() > 1) {
+                    m_animation = FrameTable::global().add(m_frames, m_region);
+                    if (isAnimatedOnGpu()) {
+                        // the animation starts with the first frame at the time the tile is created
+                        m_instance.animation = {static_cast<float>(m_animation.offset), static_cast<float>(FrameTable::global().getTime())};
+                    }
+                }
+            }
+
+            TextureTile::~TextureTile() {
+                if (isAnimatedOnGpu()) {
+                    FrameTable::global().remove(m_animation);
+                }
             }
 
             core::Identifier TextureTile::createDefaultShader() {
@@ -40,7 +59,7 @@ namespace tme {
 
             bool TextureTile::update(double deltaTime) {
                 Tile::update(deltaTime);
-                if (m_frames.size() < 2) {
+                if (m_frames.size() < 2 || isAnimatedOnGpu()) {
                     return false;
                 }
                 Frame currentFrame = m_frames[m_activeFrame];
@@ -49,19 +68,59 @@ namespace tme {
                 }
                 m_clock -= currentFrame.time;
                 m_activeFrame = (m_activeFrame + 1) % m_frames.size();
-                Frame nextFrame = m_frames[m_activeFrame];
-                m_verticies[0].texPos = {nextFrame.texPos.x, nextFrame.texPos.y};
-                m_verticies[1].texPos = {nextFrame.texPos.z, nextFrame.texPos.y};
-                m_verticies[2].texPos = {nextFrame.texPos.x, nextFrame.texPos.w};
-                m_verticies[3].texPos = {nextFrame.texPos.z, nextFrame.texPos.w};
+                m_instance.texPos = m_region.map(m_frames[m_activeFrame].texPos);
+                return true;
+            }
+
+            void TextureTile::setPosition(uint32_t x, uint32_t y) {
+                Tile::setPosition(x, y);
+                m_instance.pos = {static_cast<float>(x), static_cast<float>(y)};
+            }
+
+            bool TextureTile::matches(const Tile& other) const {
+                if (!Tile::matches(other)) {
+                    return false;
+                }
+                const auto& otherTile = static_cast<const TextureTile&>(other);
+                if (m_textureId != otherTile.m_textureId || m_frames.size() != otherTile.m_frames.size()) {
+                    return false;
+                }
+                for (size_t i = 0; i < m_frames.size(); ++i) {
+                    if (m_frames[i].time != otherTile.m_frames[i].time || m_frames[i].texPos != otherTile.m_frames[i].texPos) {
+                        return false;
+                    }
+                }
                 return true;
             }
 
+            size_t TextureTile::hash() const {
+                size_t seed = combineHash(Tile::hash(), std::hash<core::Identifier>{}(m_textureId));
+                for (const auto& frame : m_frames) {
+                    seed = combineHash(seed, std::hash<double>{}(frame.time));
+                    for (int i = 0; i < 4; ++i) {
+                        seed = combineHash(seed, std::hash<float>{}(frame.texPos[i]));
+                    }
+                }
+                return seed;
+            }
+
+            bool TextureTile::isAnimated() const {
+                return m_frames.size() > 1 && !isAnimatedOnGpu();
+            }
+
+            double TextureTile::getNextUpdate() const {
+                if (!isAnimated()) {
+                    return Tile::getNextUpdate();
+                }
+                return m_frames[m_activeFrame].time - m_clock;
+            }
+
             core::graphics::Batch::Config::Vertex TextureTile::s_vertexConfig() {
                 auto vl = core::Storage<core::graphics::VertexLayout>::global()->create();
                 vl->push<float>(2);
+                vl->push<float>(4);
                 vl->push<float>(2);
-                core::graphics::Batch::Config::Vertex vertexData(4, sizeof(Vertex), vl->getId());
+                core::graphics::Batch::Config::Vertex vertexData(1, sizeof(Instance), vl->getId());
                 return vertexData;
             }
 
@@ -69,20 +128,31 @@ namespace tme {
                 static auto vertexData = TextureTile::s_vertexConfig();
                 auto config = Tile::getBatchConfig();
                 config.vertex = vertexData;
-                config.textureId = m_textureId;
+                config.textureId = m_region.page;
                 config.preRender = [](core::Identifier shaderId, core::Identifier textureId){
                     if (auto shader = core::Storage<core::graphics::Shader>::global()->get(shaderId); shader) {
                         shader->bind();
-                        if (auto texture = core::Storage<core::graphics::Texture>::global()->get(textureId); texture) {
+                        auto texture = core::graphics::Atlas::global().getPage(textureId);
+                        if (!texture) {
+                            texture = core::Storage<core::graphics::Texture>::global()->get(textureId);
+                        }
+                        if (texture) {
                             texture->bind();
                             shader->setUniform1i("u_texture", static_cast<int>(texture->getSlot()));
                         }
+                        FrameTable::global().bind(*shader);
                     }
                 };
                 return config;
             }
             const void* TextureTile::getVertexData() const {
-                return &m_verticies;
+                return &m_instance;
+            }
+
+            void TextureTile::writeVertexData(uint32_t x, uint32_t y, void* target) const {
+                Instance instance = m_instance;
+                instance.pos = {static_cast<float>(x), static_cast<float>(y)};
+                std::memcpy(target, &instance, sizeof(Instance));
             }
 
             std::string TextureTile::toString() const {
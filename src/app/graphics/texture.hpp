@@ -5,6 +5,7 @@
 #include "app/graphics/tile.hpp"
 #include <vector>
 #include "core/storage.hpp"
+#include "core/graphics/atlas.hpp"
 #include "glm/vec2.hpp"
 #include "glm/vec4.hpp"
 
@@ -17,6 +18,12 @@ namespace tme {
              *
              * Should only be created with TextureTileFactory.
              * Allows for animations by adding frames.
+             * The texture is packed into the global Atlas, so tiles of different textures share a batch.
+             * The frames keep the coordinates on the original texture, they are only mapped onto the atlas page
+             * for rendering.
+             * Animations are stored in the FrameTable and advanced by the shader, the tile only carries the
+             * index of its first frame and its start time. Animations which do not fit into the table are
+             * advanced on the CPU with update().
              */
             class TextureTile final : public Tile {
                 public:
@@ -38,14 +45,22 @@ namespace tme {
                 using Frames = std::vector<Frame>;
 
                 private:
-                struct Vertex {
-                    glm::vec2 pos, texPos;
+                struct Instance {
+                    glm::vec2 pos;
+                    // first frame, used if the animation is not in the FrameTable
+                    glm::vec4 texPos;
+                    // index of the first frame in the FrameTable, -1 if the tile is not animated by the shader, and start time
+                    glm::vec2 animation;
                 };
 
-                Vertex m_verticies[4];
+                Instance m_instance;
                 core::Identifier m_textureId;
+                // location of the texture inside the Atlas, covers a whole texture of its own if it could not be packed
+                core::graphics::Atlas::Region m_region;
                 Frames m_frames;
                 size_t m_activeFrame;
+                // frames in the FrameTable, INVALID_OFFSET if the tile is animated on the CPU
+                core::graphics::Buffer::Space m_animation;
 
                 static core::graphics::Batch::Config::Vertex s_vertexConfig();
 
@@ -63,7 +78,9 @@ namespace tme {
                  * @param frames frames of animation to be used, has to contain at least one
                  */
                 TextureTile(core::Identifier id, uint32_t x, uint32_t y, core::Identifier shaderId, core::Identifier textureId, const Frames& frames);
-                ~TextureTile() = default;
+                TextureTile(const TextureTile&) = delete;
+                TextureTile& operator=(const TextureTile&) = delete;
+                ~TextureTile();
 
                 /**//**
                  * \brief Get global Identifier of a default shader for the tile.
@@ -79,6 +96,7 @@ namespace tme {
                  *
                  * Uses Tile::update to update the internal clock.
                  * Then updates the frame if the passed time has exceeded the duration of the frame.
+                 * Tiles animated by the shader never change.
                  *
                  * @param deltaTime time since the last update in seconds
                  *
@@ -86,8 +104,34 @@ namespace tme {
                  */
                 bool update(double deltaTime) override;
 
+                /**//**
+                 * \brief Get global id of the Texture of the tile.
+                 *
+                 * @return global Identifier of the Texture
+                 */
+                inline core::Identifier getTexture() const { return m_textureId; }
+                /**//**
+                 * \brief Get frames of animation.
+                 *
+                 * @return reference to vector of animation frames
+                 */
+                inline const Frames& getFrames() const { return m_frames; }
+                /**//**
+                 * \brief Check if the animation is advanced by the shader.
+                 *
+                 * @return true if the frames are in the FrameTable, false if the tile is not animated or animated on the CPU
+                 */
+                inline bool isAnimatedOnGpu() const { return m_animation.offset != core::graphics::INVALID_OFFSET; }
+
+                void setPosition(uint32_t x, uint32_t y) override;
+                bool matches(const Tile& other) const override;
+                size_t hash() const override;
+                bool isAnimated() const override;
+                double getNextUpdate() const override;
+
                 core::graphics::Batch::Config getBatchConfig() const override;
                 const void* getVertexData() const override;
+                void writeVertexData(uint32_t x, uint32_t y, void* target) const override;
 
                 std::string toString() const override;
             };
@@ -1,6 +1,9 @@
 /** @file */
 #include "app/graphics/tile.hpp"
+#include <functional>
+#include <limits>
 #include <sstream>
+#include <typeinfo>
 #include "core/storage.hpp"
 #include "core/graphics/batch.hpp"
 #include "core/graphics/shader.hpp"
@@ -28,6 +31,45 @@ namespace tme {
                 return m_id;
             }
 
+            void Tile::setPosition(uint32_t x, uint32_t y) {
+                m_x = x;
+                m_y = y;
+                m_id = generateId(x, y);
+            }
+
+            bool Tile::matches(const Tile& other) const {
+                return typeid(*this) == typeid(other) && m_shaderId == other.m_shaderId;
+            }
+
+            size_t Tile::hash() const {
+                return combineHash(typeid(*this).hash_code(), std::hash<core::Identifier>{}(m_shaderId));
+            }
+
+            size_t Tile::combineHash(size_t seed, size_t value) {
+                return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+            }
+
+            bool Tile::isAnimated() const {
+                return false;
+            }
+
+            double Tile::getNextUpdate() const {
+                return std::numeric_limits<double>::infinity();
+            }
+
+            core::Identifier Tile::generateId(uint32_t x, uint32_t y) {
+                // spread the 32 bits of a coordinate to every other bit of 64 bits
+                auto spread = [](uint64_t value) {
+                    value = (value | (value << 16)) & 0x0000ffff0000ffff;
+                    value = (value | (value << 8)) & 0x00ff00ff00ff00ff;
+                    value = (value | (value << 4)) & 0x0f0f0f0f0f0f0f0f;
+                    value = (value | (value << 2)) & 0x3333333333333333;
+                    value = (value | (value << 1)) & 0x5555555555555555;
+                    return value;
+                };
+                return spread(x) | (spread(y) << 1);
+            }
+
             void Tile::setIndexOffset(unsigned int indexOffset) {
                 m_indices = Index(indexOffset);
             }
@@ -40,6 +82,8 @@ namespace tme {
                 return NULL;
             }
 
+            void Tile::writeVertexData(uint32_t, uint32_t, void*) const {}
+
             std::string Tile::toString() const {
                 std::stringstream ss;
                 ss << "Tile(" << m_x << ',' << m_y << ',' << m_shaderId << ')';
@@ -58,7 +102,21 @@ namespace tme {
                             if (auto shader = core::Storage<core::graphics::Shader>::global()->get(shaderId); shader) {
                                 shader->bind();
                             }
-                        }, m_shaderId, core::graphics::NO_TEXTURE);
+                        }, m_shaderId, core::graphics::NO_TEXTURE, true);
+            }
+
+
+            PlacedTile::PlacedTile(core::Handle<Tile> tile, uint32_t x, uint32_t y)
+                : m_tile(tile),
+                m_id(Tile::generateId(x, y)),
+                m_indices(0),
+                m_vertexData() {
+                TME_ASSERT(m_tile->getBatchConfig().vertex.size <= s_maxVertexSize, "vertex data of the tile does not fit");
+                m_tile->writeVertexData(x, y, m_vertexData);
+            }
+
+            void PlacedTile::setIndexOffset(unsigned int indexOffset) {
+                m_indices = Tile::Index(indexOffset);
             }
 
 
@@ -68,7 +126,7 @@ namespace tme {
             TileFactory::~TileFactory() {}
 
             core::Identifier TileFactory::generateId() const {
-                return (m_x << 16) | m_y;
+                return Tile::generateId(m_x, m_y);
             }
 
             void TileFactory::setPosition(uint32_t x, uint32_t y) {
@@ -9,6 +9,8 @@ namespace tme {
     namespace app {
         namespace graphics {
 
+            class PlacedTile;
+
             /**//**
              * \brief Base class for tiles.
              *
@@ -17,13 +19,20 @@ namespace tme {
              * @sa TileFactory
              * Implements a default index, providing access to its definition, update functionality
              * and data access.
+             * Tiles are rendered instanced, all tiles of a batch share the default index of a single quad
+             * and only provide their per instance data as vertex data.
+             * A single Tile can represent all matching tiles of a TileGrid through a PlacedTile per cell,
+             * so all of them share its animation state.
              */
             class Tile : public core::Loggable, public core::graphics::Batchable {
+                friend class PlacedTile;
+
                 protected:
                 /**//**
                  * \brief Default index structure of a Tile.
                  *
                  * Consists of two triangles forming a square.
+                 * The shaders derive the corners of the square from the vertex index 0 to 3.
                  */
                 struct Index {
                     /**//**
@@ -96,6 +105,77 @@ namespace tme {
 
                 core::Identifier getId() const override;
 
+                /**//**
+                 * \brief Get x position of the tile.
+                 *
+                 * @return position on the x axis in full tiles
+                 */
+                inline uint32_t getX() const { return m_x; }
+                /**//**
+                 * \brief Get y position of the tile.
+                 *
+                 * @return position on the y axis in full tiles
+                 */
+                inline uint32_t getY() const { return m_y; }
+                /**//**
+                 * \brief Get global id of the Shader of the tile.
+                 *
+                 * @return global Identifier of the Shader used to render the tile
+                 */
+                inline core::Identifier getShader() const { return m_shaderId; }
+                /**//**
+                 * \brief Move the tile to another position.
+                 *
+                 * Updates the identifier to the one of the new position.
+                 *
+                 * @param x position of the tile on x axis in full tiles
+                 * @param y position of the tile on y axis in full tiles
+                 */
+                virtual void setPosition(uint32_t x, uint32_t y);
+
+                /**//**
+                 * \brief Check if the tile looks the same as another tile regardless of the position.
+                 *
+                 * @param other the Tile to compare against
+                 *
+                 * @return true if both tiles are of the same type, use the same shader and have the same content
+                 */
+                virtual bool matches(const Tile& other) const;
+                /**//**
+                 * \brief Calculate hash of the content compared by matches().
+                 *
+                 * @return hash value, equal for matching tiles
+                 */
+                virtual size_t hash() const;
+
+                /**//**
+                 * \brief Check if the tile changes over time.
+                 *
+                 * @return true if update() may return true, false otherwise
+                 */
+                virtual bool isAnimated() const;
+                /**//**
+                 * \brief Get time until the tile changes.
+                 *
+                 * Passing the returned value to update() makes it return true.
+                 *
+                 * @return time in seconds until the next change, infinity for tiles without animation
+                 */
+                virtual double getNextUpdate() const;
+
+                /**//**
+                 * \brief Generate id of a tile based on its position.
+                 *
+                 * Interleaves the bits of both coordinates (Morton order), so every position has a unique id
+                 * and sorting by id keeps neighbouring tiles close together.
+                 *
+                 * @param x position in x direction in full tiles
+                 * @param y position in y direction in full tiles
+                 *
+                 * @return id of a Tile at that position
+                 */
+                static core::Identifier generateId(uint32_t x, uint32_t y);
+
                 /**//**
                  * \brief Updates internal clock.
                  *
@@ -111,6 +191,16 @@ namespace tme {
                 virtual void setIndexOffset(unsigned int indexOffset) override;
                 virtual const void* getIndexData() const override;
                 virtual const void* getVertexData() const override;
+                /**//**
+                 * \brief Write the vertex data a matching tile at another position would have.
+                 *
+                 * The tile itself is not moved.
+                 *
+                 * @param x position on the x axis in full tiles
+                 * @param y position on the y axis in full tiles
+                 * @param target receives getBatchConfig().vertex.size bytes
+                 */
+                virtual void writeVertexData(uint32_t x, uint32_t y, void* target) const;
 
                 virtual std::string toString() const override;
 
@@ -121,6 +211,54 @@ namespace tme {
                  * @return index description to be used in a batch config
                  */
                 static core::graphics::Batch::Config::Index s_indexConfig();
+                /**//**
+                 * \brief Mix a value into a hash.
+                 *
+                 * @param seed hash calculated so far
+                 * @param value hash of the value to be added
+                 *
+                 * @return combined hash
+                 */
+                static size_t combineHash(size_t seed, size_t value);
+            };
+
+            /**//**
+             * \brief Batchable standing in for a matching tile at another position.
+             *
+             * Copies the vertex data of the tile for its position, so the tile itself is left unchanged.
+             * Allows a single Tile to be added to a Batcher for every cell of a TileGrid.
+             */
+            class PlacedTile final : public core::graphics::Batchable {
+                // large enough for the instance data of all tiles
+                static constexpr size_t s_maxVertexSize = 64;
+
+                core::Handle<Tile> m_tile;
+                core::Identifier m_id;
+                Tile::Index m_indices;
+                alignas(16) unsigned char m_vertexData[s_maxVertexSize];
+
+                public:
+                /**//**
+                 * \brief Construct PlacedTile.
+                 *
+                 * @param tile the Tile providing the content
+                 * @param x position on the x axis in full tiles
+                 * @param y position on the y axis in full tiles
+                 */
+                PlacedTile(core::Handle<Tile> tile, uint32_t x, uint32_t y);
+
+                /**//**
+                 * \brief Get the tile providing the content.
+                 *
+                 * @return Handle to the Tile
+                 */
+                inline core::Handle<Tile> getTile() const { return m_tile; }
+
+                core::Identifier getId() const override { return m_id; }
+                core::graphics::Batch::Config getBatchConfig() const override { return m_tile->getBatchConfig(); }
+                void setIndexOffset(unsigned int indexOffset) override;
+                const void* getIndexData() const override { return &m_indices; }
+                const void* getVertexData() const override { return m_vertexData; }
             };
 
 
@@ -170,6 +308,18 @@ namespace tme {
                  * @param y position in y direction in full tiles
                  */
                 void setPosition(uint32_t x, uint32_t y);
+                /**//**
+                 * \brief Get x position of the to be created Tile.
+                 *
+                 * @return position in x direction in full tiles
+                 */
+                inline uint32_t getX() const { return m_x; }
+                /**//**
+                 * \brief Get y position of the to be created Tile.
+                 *
+                 * @return position in y direction in full tiles
+                 */
+                inline uint32_t getY() const { return m_y; }
 
                 /**//**
                  * \brief Update associated Shader.
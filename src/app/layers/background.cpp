@@ -8,15 +8,14 @@ namespace tme {
         namespace layers {
 
             Background::Background(uint32_t width, uint32_t height, glm::vec4 color)
-                : Layer("Background"), m_batcher(width * height) {
-                m_tiles = core::Storage<graphics::Tile>::localInstance();
+                : Layer("Background"), m_batcher(width * height), m_color(color) {
                 graphics::ColorTileFactory factory;
                 factory.setColor(color);
+                core::Handle<graphics::Tile> tile(factory.construct());
                 for (uint32_t x = 0; x < width; ++x) {
                     for (uint32_t y = 0; y < height; ++y) {
-                        factory.setPosition(x, y);
-                        auto tile = m_tiles->add(factory.construct());
-                        m_batcher.set(tile);
+                        tile->setPosition(x, y);
+                        m_batcher.set(*tile);
                     }
                 }
             }
@@ -25,6 +24,10 @@ namespace tme {
                 m_batcher.render();
             }
 
+            void Background::submit(core::graphics::RenderQueue& queue) const {
+                m_batcher.submit(queue, 0);
+            }
+
         }
     }
 }
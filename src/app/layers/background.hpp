@@ -4,6 +4,7 @@
 
 #include "core/layers/layer.hpp"
 #include "core/graphics/batch.hpp"
+#include "core/graphics/renderqueue.hpp"
 #include "app/graphics/tile.hpp"
 #include "glm/vec4.hpp"
 
@@ -16,10 +17,11 @@ namespace tme {
              *
              * Allows to set a set area of the screen to a single color.
              * Fills entire area of a tilemap in one solid color using multiple ColorTile.
+             * A single ColorTile is moved over the area as the batches keep their own copy of the data.
              */
             class Background final : public core::layers::Layer {
                 core::graphics::Batcher m_batcher;
-                core::Handle<core::Storage<graphics::Tile>> m_tiles;
+                glm::vec4 m_color;
 
                 public:
                 /**//**
@@ -34,7 +36,20 @@ namespace tme {
                 Background(uint32_t width, uint32_t height, glm::vec4 color);
                 ~Background() = default;
 
+                /**//**
+                 * \brief Get color of the background.
+                 *
+                 * @return color of all tiles
+                 */
+                inline glm::vec4 getColor() const { return m_color; }
+
                 void render() override;
+                /**//**
+                 * \brief Submit the background to a RenderQueue below all other layers.
+                 *
+                 * @param queue the RenderQueue the background is rendered by
+                 */
+                void submit(core::graphics::RenderQueue& queue) const;
             };
 
         }
@@ -27,6 +27,7 @@ namespace tme {
                     shader->bind();
                     shader->setUniformMat4f("u_mvp", m_camera.getMVP());
                 }
+                m_tilemap->setViewport(m_camera);
                 m_tilemap->render();
             }
 
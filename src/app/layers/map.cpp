@@ -1,6 +1,8 @@
 /** @file */
 
 #include "app/layers/map.hpp"
+#include <algorithm>
+#include <string>
 #include "core/events/window.hpp"
 #include "core/exceptions/input.hpp"
 #include "core/layers/layer.hpp"
@@ -11,18 +13,185 @@ namespace tme {
     namespace app {
         namespace layers {
 
-            MapLayer::MapLayer(size_t layerNumber, size_t size, core::Handle<Cursor> cursor)
-                : core::layers::Layer("MapLayer"),
+            MapLayer::MapLayer(size_t layerNumber, uint32_t width, uint32_t height, core::Handle<Cursor> cursor, core::Handle<Viewport> viewport, core::Handle<core::graphics::RenderQueue> renderQueue)
+                : core::layers::Layer("MapLayer " + std::to_string(layerNumber)),
                 Dispatcher(this),
                 m_layerNumber(layerNumber),
                 m_cursor(cursor),
-                m_batcher(size) {
-                m_tiles = core::Storage<graphics::Tile>::localInstance();
-            }
+                m_viewport(viewport),
+                m_renderQueue(renderQueue),
+                m_tiles(width, height, s_chunkSize),
+                m_animator(),
+                m_batchPool(new core::graphics::BatchPool(s_initialBatchSize)),
+                m_chunks(static_cast<size_t>(m_tiles.getChunksX()) * m_tiles.getChunksY()),
+                m_pendingChunks(m_chunks.size(), false),
+                m_loader(nullptr),
+                m_chunkStates(m_chunks.size(), ChunkState::Resident),
+                m_modifiedChunks(m_chunks.size(), false),
+                m_keptChunks() {}
             MapLayer::~MapLayer() {}
 
+            void MapLayer::stream(core::Handle<ChunkLoader> loader) {
+                TME_ASSERT(loader->getFile().getHeader().width == m_tiles.getWidth()
+                        && loader->getFile().getHeader().height == m_tiles.getHeight()
+                        && loader->getFile().getHeader().chunkSize == s_chunkSize, "tilemap file does not match the layer");
+                TME_ASSERT(m_tiles.getKindCount() == 0, "tiles can only be streamed into an empty layer");
+
+                TileGrid::Kind expected = TileGrid::EMPTY;
+                for (const auto& prototype : loader->getFile().createPrototypes(m_layerNumber)) {
+                    auto kind = m_tiles.addKind(prototype);
+                    if (kind != ++expected) {
+                        throw core::exceptions::InvalidInput("duplicate tile kinds in tilemap file");
+                    }
+                }
+                m_loader = loader;
+                std::fill(m_chunkStates.begin(), m_chunkStates.end(), ChunkState::Stored);
+                TME_INFO("streaming {} from {}", m_tiles, *m_loader);
+            }
+
+            void MapLayer::receive(ChunkLoader::Chunk& chunk) {
+                if (chunk.index >= m_chunkStates.size() || m_chunkStates[chunk.index] != ChunkState::Loading) {
+                    return;
+                }
+                m_chunkStates[chunk.index] = ChunkState::Resident;
+                try {
+                    m_pendingChunks[chunk.index] = m_tiles.setChunk(chunk.index, std::move(chunk.kinds)) > 0;
+                    scheduleAnimations(chunk.index);
+                } catch(const core::exceptions::InvalidInput& e) {
+                    TME_WARN("could not load chunk {} of layer {}: {}", chunk.index, m_layerNumber, e.what());
+                } CATCH_ALL
+            }
+
+            void MapLayer::readChunk(size_t index, TileGrid::Kind* kinds) const {
+                size_t size = static_cast<size_t>(s_chunkSize) * s_chunkSize;
+                TileGrid::Chunk stored;
+                const TileGrid::Kind* source = m_tiles.getChunk(index);
+                if (m_chunkStates[index] != ChunkState::Resident) {
+                    stored = m_loader->read(m_layerNumber, index);
+                    source = stored.get();
+                }
+                if (source) {
+                    std::copy(source, source + size, kinds);
+                } else {
+                    std::fill(kinds, kinds + size, TileGrid::EMPTY);
+                }
+            }
+
             void MapLayer::render() {
-                m_batcher.render();
+                auto kept = getVisibleChunks(s_keepMargin);
+                if (kept != m_keptChunks) {
+                    dropChunks(kept);
+                    m_keptChunks = kept;
+                }
+                if (m_loader) {
+                    requestChunks(getVisibleChunks(s_prefetchMargin));
+                }
+
+                auto visible = getVisibleChunks(0);
+                size_t fills = 0;
+                for (uint32_t y = visible.firstY; y <= visible.lastY; ++y) {
+                    for (uint32_t x = visible.firstX; x <= visible.lastX; ++x) {
+                        size_t index = static_cast<size_t>(y) * m_tiles.getChunksX() + x;
+                        if (m_pendingChunks[index] && fills++ < s_fillsPerFrame) {
+                            getChunk(index);
+                        }
+                    }
+                }
+                // the shared batches contain the kept chunks around the Viewport as well, they are clipped by the GPU
+                // which is cheaper than a draw call per visible chunk, the background is drawn below all map layers
+                m_batchPool->submit(*m_renderQueue, static_cast<uint16_t>(m_layerNumber + 1));
+            }
+
+            MapLayer::ChunkRange MapLayer::getVisibleChunks(uint32_t margin) const {
+                ChunkRange range;
+                if (m_viewport->width == 0 || m_viewport->height == 0) {
+                    return range;
+                }
+                uint32_t firstX = m_viewport->x / s_chunkSize;
+                uint32_t firstY = m_viewport->y / s_chunkSize;
+                uint32_t lastX = (m_viewport->x + m_viewport->width - 1) / s_chunkSize;
+                uint32_t lastY = (m_viewport->y + m_viewport->height - 1) / s_chunkSize;
+                range.firstX = firstX - std::min(firstX, margin);
+                range.firstY = firstY - std::min(firstY, margin);
+                range.lastX = std::min(lastX + margin, m_tiles.getChunksX() - 1);
+                range.lastY = std::min(lastY + margin, m_tiles.getChunksY() - 1);
+                return range;
+            }
+
+            void MapLayer::requestChunks(const ChunkRange& range) {
+                for (uint32_t y = range.firstY; y <= range.lastY; ++y) {
+                    for (uint32_t x = range.firstX; x <= range.lastX; ++x) {
+                        size_t index = static_cast<size_t>(y) * m_tiles.getChunksX() + x;
+                        if (m_chunkStates[index] != ChunkState::Stored) {
+                            continue;
+                        }
+                        if (!m_loader->request(m_layerNumber, index)) {
+                            // try again next frame
+                            return;
+                        }
+                        m_chunkStates[index] = ChunkState::Loading;
+                    }
+                }
+            }
+
+            void MapLayer::dropChunks(const ChunkRange& range) {
+                for (uint32_t y = m_keptChunks.firstY; y <= m_keptChunks.lastY; ++y) {
+                    for (uint32_t x = m_keptChunks.firstX; x <= m_keptChunks.lastX; ++x) {
+                        if (range.contains(x, y)) {
+                            continue;
+                        }
+                        size_t index = static_cast<size_t>(y) * m_tiles.getChunksX() + x;
+                        m_chunks[index].reset();
+                        m_pendingChunks[index] = m_tiles.getChunk(index) != nullptr;
+                        if (!m_loader || m_modifiedChunks[index]) {
+                            continue;
+                        }
+                        // results of chunks still loading are ignored once they arrive
+                        m_tiles.clearChunk(index);
+                        m_chunkStates[index] = ChunkState::Stored;
+                        m_pendingChunks[index] = false;
+                    }
+                }
+            }
+
+            void MapLayer::makeResident(size_t index) {
+                if (m_chunkStates[index] == ChunkState::Resident) {
+                    return;
+                }
+                m_chunkStates[index] = ChunkState::Resident;
+                try {
+                    m_pendingChunks[index] = m_tiles.setChunk(index, m_loader->read(m_layerNumber, index)) > 0;
+                    scheduleAnimations(index);
+                } catch(const core::exceptions::InvalidInput& e) {
+                    TME_WARN("could not load chunk {} of layer {}: {}", index, m_layerNumber, e.what());
+                } CATCH_ALL
+            }
+
+            void MapLayer::scheduleAnimations(size_t index) {
+                m_tiles.forEachInChunk(index, [this](uint32_t, uint32_t, TileGrid::Kind kind) {
+                    if (m_tiles.hasAnimatedCells(kind)) {
+                        m_animator.add(kind, *m_tiles.getPrototype(kind));
+                    }
+                });
+            }
+
+            core::graphics::Batcher& MapLayer::getChunk(uint32_t x, uint32_t y) {
+                return getChunk(m_tiles.getChunkIndex(x, y));
+            }
+
+            core::graphics::Batcher& MapLayer::getChunk(size_t index) {
+                auto& chunk = m_chunks[index];
+                if (!chunk) {
+                    chunk = std::make_unique<core::graphics::Batcher>(m_batchPool);
+                }
+                if (m_pendingChunks[index]) {
+                    m_pendingChunks[index] = false;
+                    m_tiles.forEachInChunk(index, [this, &chunk](uint32_t x, uint32_t y, TileGrid::Kind) {
+                        auto tile = m_tiles.get(x, y);
+                        chunk->set(tile);
+                    });
+                }
+                return *chunk;
             }
 
             void MapLayer::onEvent(core::events::Event& event) {
@@ -30,11 +199,16 @@ namespace tme {
             }
 
             bool MapLayer::handleWindowUpdate(core::events::WindowUpdate& event) {
-                // update tiles
-                for (auto iter : *m_tiles) {
-                    if (iter.second->update(event.getDeltaTime())) {
-                        m_batcher.set(iter.second);
-                    }
+                // upload tiles of kinds whose animation advanced
+                for (auto kind : m_animator.update(event.getDeltaTime(), m_tiles)) {
+                    m_tiles.forEachOfKind(kind, [this](uint32_t x, uint32_t y) {
+                        // pending chunks pick up the current frame once they are filled
+                        size_t index = m_tiles.getChunkIndex(x, y);
+                        if (m_chunks[index] && !m_pendingChunks[index]) {
+                            auto tile = m_tiles.get(x, y);
+                            m_chunks[index]->set(tile);
+                        }
+                    });
                 }
 
                 // place/erase operations
@@ -42,10 +216,18 @@ namespace tme {
                     return false;
                 }
                 if (m_cursor->inBounds && m_cursor->placeTile) {
-                    if (!m_tiles->has(m_cursor->tileFactory->generateId())) {
+                    uint32_t x = m_cursor->tileFactory->getX();
+                    uint32_t y = m_cursor->tileFactory->getY();
+                    size_t index = m_tiles.getChunkIndex(x, y);
+                    makeResident(index);
+                    if (!m_tiles.has(x, y)) {
                         try {
-                            auto tile = m_tiles->add(m_cursor->tileFactory->construct());
-                            m_batcher.set(tile);
+                            auto kind = m_tiles.addKind(core::Handle<graphics::Tile>(m_cursor->tileFactory->construct()));
+                            m_tiles.set(x, y, kind);
+                            m_animator.add(kind, *m_tiles.getPrototype(kind));
+                            auto tile = m_tiles.get(x, y);
+                            getChunk(x, y).set(tile);
+                            m_modifiedChunks[index] = true;
                         } catch(const core::exceptions::InvalidInput& e) {
                             TME_WARN("could not create tile: {}", e.what());
                         } CATCH_ALL
@@ -53,10 +235,14 @@ namespace tme {
                     return true;
                 }
                 if (m_cursor->inBounds && m_cursor->eraseTile) {
-                    core::Identifier tileId = m_cursor->tileFactory->generateId();
-                    if (m_tiles->has(tileId)) {
-                        m_batcher.unset(m_tiles->get(tileId));
-                        m_tiles->destroy(tileId);
+                    uint32_t x = m_cursor->tileFactory->getX();
+                    uint32_t y = m_cursor->tileFactory->getY();
+                    size_t index = m_tiles.getChunkIndex(x, y);
+                    makeResident(index);
+                    if (m_tiles.has(x, y)) {
+                        getChunk(x, y).unset(m_tiles.get(x, y));
+                        m_tiles.erase(x, y);
+                        m_modifiedChunks[index] = true;
                     }
                     return true;
                 }
@@ -2,13 +2,19 @@
 #define _APP_LAYERS_MAP_H
 /** @file */
 
+#include <memory>
+#include <vector>
 #include "core/events/event.hpp"
 #include "core/events/dispatcher.hpp"
 #include "core/events/window.hpp"
 #include "core/graphics/batch.hpp"
+#include "core/graphics/renderqueue.hpp"
 #include "core/layers/layer.hpp"
 #include "core/storage.hpp"
 #include "app/tilemap.hpp"
+#include "app/tilegrid.hpp"
+#include "app/animator.hpp"
+#include "app/chunkloader.hpp"
 
 namespace tme {
     namespace app {
@@ -18,31 +24,137 @@ namespace tme {
              * \brief Tilemap Layer handling the creation and deletion of tiles.
              *
              * Uses the Cursor of the Tilemap to determine if it should add/remove tiles every frame.
-             * Additionally updates all tiles with the delta time of the WindowUpdate.
+             * Additionally advances the animations of due tiles with the delta time of the WindowUpdate.
+             * The layer is split into square chunks with their own Batcher, only chunks
+             * intersecting the Viewport of the Tilemap are filled.
+             * The Batchers of all chunks share one BatchPool, so each tile kind config of the layer is drawn with one draw call.
+             * Batches of chunks far away from the Viewport are dropped and filled again once they come close.
+             * Layers streamed from a tilemap file additionally load the tiles of chunks around the Viewport
+             * in the background and drop them again when they are far away and have not been edited.
              */
             class MapLayer final : public core::layers::Layer, public core::events::Dispatcher<MapLayer> {
+                enum class ChunkState : uint8_t {
+                    // tiles are in the TileGrid
+                    Resident,
+                    // tiles are only in the file
+                    Stored,
+                    // tiles have been requested from the ChunkLoader
+                    Loading,
+                };
+
+                // number of tiles in each direction of a chunk
+                static constexpr uint32_t s_chunkSize = 32;
+                // batches are shared by all chunks and grow on demand, start with room for one chunk
+                static constexpr size_t s_initialBatchSize = static_cast<size_t>(s_chunkSize) * s_chunkSize;
+                // chunks around the Viewport which are loaded ahead of time
+                static constexpr uint32_t s_prefetchMargin = 1;
+                // chunks around the Viewport which are kept, larger than the prefetch margin to avoid reloading at the border
+                static constexpr uint32_t s_keepMargin = 2;
+                // batches filled per frame, the remaining chunks are filled in the following frames
+                static constexpr size_t s_fillsPerFrame = 4;
+
+                // inclusive range of chunks, empty by default
+                struct ChunkRange {
+                    uint32_t firstX = 1, firstY = 1, lastX = 0, lastY = 0;
+
+                    bool contains(uint32_t x, uint32_t y) const { return x >= firstX && x <= lastX && y >= firstY && y <= lastY; }
+                    bool operator!=(const ChunkRange& other) const {
+                        return firstX != other.firstX || firstY != other.firstY || lastX != other.lastX || lastY != other.lastY;
+                    }
+                };
+
                 size_t m_layerNumber;
                 core::Handle<Cursor> m_cursor;
-                core::graphics::Batcher m_batcher;
-                core::Handle<core::Storage<graphics::Tile>> m_tiles;
+                core::Handle<Viewport> m_viewport;
+                core::Handle<core::graphics::RenderQueue> m_renderQueue;
+                TileGrid m_tiles;
+                Animator m_animator;
+                // batches of all chunks, declared before the chunks so they are deleted after them
+                core::Handle<core::graphics::BatchPool> m_batchPool;
+                // row major, created when the first tile is placed inside or a chunk with tiles becomes visible
+                std::vector<std::unique_ptr<core::graphics::Batcher>> m_chunks;
+                // chunks with tiles in the TileGrid which have not been added to a Batcher yet
+                std::vector<bool> m_pendingChunks;
+                // source of streamed layers, nullptr otherwise
+                core::Handle<ChunkLoader> m_loader;
+                std::vector<ChunkState> m_chunkStates;
+                // edited chunks are never dropped as the file does not contain the changes
+                std::vector<bool> m_modifiedChunks;
+                // all chunks with a Batcher or streamed tiles are within this range
+                ChunkRange m_keptChunks;
 
                 public:
                 /**//**
                  * \brief Construct MapLayer of a Tilemap.
                  *
                  * @param layerNumber the number of the layer, layers with higher numbers are on top of lower numbers
-                 * @param size how many tiles the map layer should be able to contain
+                 * @param width number of tiles in the x direction
+                 * @param height number of tiles in the y direction
                  * @param cursor Handle to the Cursor of the Tilemap that should be edited with this layer
+                 * @param viewport Handle to the Viewport of the Tilemap limiting which tiles are rendered
+                 * @param renderQueue Handle to the RenderQueue of the Tilemap the batches of the layer are submitted to
                  */
-                MapLayer(size_t layerNumber, size_t size, core::Handle<Cursor> cursor);
+                MapLayer(size_t layerNumber, uint32_t width, uint32_t height, core::Handle<Cursor> cursor, core::Handle<Viewport> viewport, core::Handle<core::graphics::RenderQueue> renderQueue);
                 ~MapLayer();
 
+                /**//**
+                 * \brief Stream the empty layer from a tilemap file.
+                 *
+                 * Creates the tile kinds of the layer with the same number from the file,
+                 * the tiles themselves are loaded once their chunks come close to the Viewport.
+                 *
+                 * @param loader Handle to the ChunkLoader of the file, the file has to have the same dimensions as the layer
+                 *               and no tiles may have been placed in the layer before
+                 *
+                 * @throw InvalidInput when the layer is invalid or its resources can not be created
+                 */
+                void stream(core::Handle<ChunkLoader> loader);
+                /**//**
+                 * \brief Take over a chunk loaded in the background.
+                 *
+                 * Chunks which are no longer expected, because they have been dropped or loaded otherwise, are ignored.
+                 *
+                 * @param chunk the loaded chunk of this layer
+                 */
+                void receive(ChunkLoader::Chunk& chunk);
+
+                /**//**
+                 * \brief Copy the tiles of a chunk.
+                 *
+                 * Chunks which are not loaded are read from the file.
+                 *
+                 * @param index row major index of the chunk
+                 * @param kinds receives the chunkSize * chunkSize kinds of the chunk
+                 */
+                void readChunk(size_t index, TileGrid::Kind* kinds) const;
+
+                /**//**
+                 * \brief Get tiles of the layer.
+                 *
+                 * @return reference to the TileGrid
+                 */
+                inline const TileGrid& getTiles() const { return m_tiles; }
+                /**//**
+                 * \brief Get size of the chunks.
+                 *
+                 * @return number of tiles in each direction of a chunk
+                 */
+                static constexpr uint32_t getChunkSize() { return s_chunkSize; }
+
                 void render() override;
 
                 void onEvent(core::events::Event& event) override;
 
                 private:
                 bool handleWindowUpdate(core::events::WindowUpdate& event);
+                core::graphics::Batcher& getChunk(uint32_t x, uint32_t y);
+                core::graphics::Batcher& getChunk(size_t index);
+                ChunkRange getVisibleChunks(uint32_t margin) const;
+                void requestChunks(const ChunkRange& range);
+                void dropChunks(const ChunkRange& range);
+                void makeResident(size_t index);
+                // schedules the animated kinds of a chunk, the Animator drops kinds once their last tile is gone
+                void scheduleAnimations(size_t index);
             };
 
         }
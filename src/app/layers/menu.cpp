@@ -2,9 +2,11 @@
 
 #include "app/layers/menu.hpp"
 #include "app/editor.hpp"
+#include "core/exceptions/input.hpp"
 
 #include "glm/vec4.hpp"
 #include "imgui.h"
+#include "ImGuiFileDialog.h"
 
 namespace tme {
     namespace app {
@@ -28,8 +30,16 @@ namespace tme {
                     if (ImGui::MenuItem("New")) {
                         openNewDialog = true;
                     }
+                    if (ImGui::MenuItem("Open")) {
+                        ImGuiFileDialog::Instance()->OpenDialog("OpenMapDlgKey", "Open tilemap", ".tme", ".");
+                    }
+                    bool hasTilemap = static_cast<bool>(core::Storage<Editor>::global()->get(m_editorId)->getTilemap());
+                    if (ImGui::MenuItem("Save", nullptr, false, hasTilemap)) {
+                        ImGuiFileDialog::Instance()->OpenDialog("SaveMapDlgKey", "Save tilemap", ".tme", ".");
+                    }
                     ImGui::EndMenu();
                 }
+                showFileDialogs();
 
                 if (openNewDialog) {
                     ImGui::SetNextWindowSize(ImVec2(550, 1000), ImGuiCond_FirstUseEver);
@@ -61,6 +71,32 @@ namespace tme {
                     ImGui::End();
                 }
             }
+
+            void MenuBar::showFileDialogs() {
+                auto editor = core::Storage<Editor>::global()->get(m_editorId);
+                if (ImGuiFileDialog::Instance()->Display("OpenMapDlgKey")) {
+                    if (ImGuiFileDialog::Instance()->IsOk()) {
+                        std::string filePath = ImGuiFileDialog::Instance()->GetFilePathName();
+                        try {
+                            editor->setTilemap(core::Storage<Tilemap>::global()->create(filePath));
+                        } catch(const core::exceptions::InvalidInput& e) {
+                            TME_WARN("could not open tilemap {}: {}", filePath, e.what());
+                        } CATCH_ALL
+                    }
+                    ImGuiFileDialog::Instance()->Close();
+                }
+                if (ImGuiFileDialog::Instance()->Display("SaveMapDlgKey")) {
+                    if (ImGuiFileDialog::Instance()->IsOk() && editor->getTilemap()) {
+                        std::string filePath = ImGuiFileDialog::Instance()->GetFilePathName();
+                        try {
+                            editor->getTilemap()->save(filePath);
+                        } catch(const core::exceptions::InvalidInput& e) {
+                            TME_WARN("could not save tilemap {}: {}", filePath, e.what());
+                        } CATCH_ALL
+                    }
+                    ImGuiFileDialog::Instance()->Close();
+                }
+            }
                 
         }
     }
@@ -31,6 +31,7 @@ namespace tme {
 
                 private:
                 void showFileOptions();
+                void showFileDialogs();
             };
 
         }
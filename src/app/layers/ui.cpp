@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include "app/graphics/tile.hpp"
 #include "core/exceptions/input.hpp"
+#include "core/graphics/loader.hpp"
 #include "core/graphics/shader.hpp"
 #include "core/graphics/texture.hpp"
 #include "core/storage.hpp"
@@ -20,8 +21,7 @@ namespace tme {
             EditingUI::EditingUI(core::Handle<Tilemap> tilemap)
                 : Layer("EditingUI"),
                 m_tilemap(tilemap),
-                m_errorOccurred(false),
-                m_error("No error", "Will be overwritten in actual error cases") {
+                m_error(new Error{false, core::exceptions::Base("No error", "Will be overwritten in actual error cases")}) {
                 m_colorTileFactory = core::Handle<graphics::ColorTileFactory>(new graphics::ColorTileFactory());
                 m_textureTileFactory = core::Handle<graphics::TextureTileFactory>(new graphics::TextureTileFactory(0));
                 m_tilemap->getCursor()->tileFactory = m_colorTileFactory;
@@ -101,6 +101,12 @@ namespace tme {
                     return;
                 }
 
+                // frames are picked on the image, wait until it is loaded
+                if (core::Storage<core::graphics::Texture>::global()->get(m_textureTileFactory->getTexture())->isPending()) {
+                    ImGui::Text("Loading texture...");
+                    return;
+                }
+
                 static double frameTime = 0.0;
                 ImGui::InputDouble("Frame time in seconds", &frameTime, 0.1, 1.0);
                 static ImVec2 imageSize = ImVec2(64.0, 64.0);
@@ -190,30 +196,44 @@ namespace tme {
                     }
                     ImGui::SameLine();
                 }
+                static int format = 0;
+                static bool mipmaps = false;
+                const char* formatNames[] = {"RGBA8", "sRGB RGBA8", "Gray (red channel)", "Compressed RGBA", "Compressed gray (red channel)"};
+                const core::graphics::Texture::Format formats[] = {
+                    core::graphics::Texture::RGBA8,
+                    core::graphics::Texture::SRGBA8,
+                    core::graphics::Texture::R8,
+                    core::graphics::Texture::CompressedRGBA,
+                    core::graphics::Texture::CompressedR
+                };
+                ImGui::Combo("Format", &format, formatNames, IM_ARRAYSIZE(formatNames));
+                ImGui::Checkbox("Mipmaps", &mipmaps);
                 if (ImGui::Button("Add texture")) {
                     ImGuiFileDialog::Instance()->OpenDialog("ChooseFileDlgKey", "Choose image file", ".png,.bmp,.gif", ".");
                 }
                 if (ImGuiFileDialog::Instance()->Display("ChooseFileDlgKey")) {
                     if (ImGuiFileDialog::Instance()->IsOk()) {
                         std::string filePath = ImGuiFileDialog::Instance()->GetFilePathName();;
-                        try {
-                            auto texture = core::Storage<core::graphics::Texture>::global()->create(filePath);
-                            m_textureTileFactory->setTexture(texture->getId());
-                        } catch(const core::exceptions::InvalidInput& e) {
-                            m_errorOccurred = true;
-                            m_error = e;
-                        } CATCH_ALL
+                        // decoding happens in the background, the placeholder is selected right away
+                        auto texture = core::graphics::TextureLoader::global().load(filePath, [error = std::weak_ptr<Error>(m_error)](core::Handle<core::graphics::Texture> loaded) {
+                            auto shared = error.lock();
+                            if (!loaded && shared) {
+                                shared->occurred = true;
+                                shared->exception = core::exceptions::InvalidInput("could not read image file");
+                            }
+                        }, {formats[format], mipmaps});
+                        m_textureTileFactory->setTexture(texture->getId());
                     }
                     ImGuiFileDialog::Instance()->Close();
                 }
             }
 
             void EditingUI::showErrors() {
-                if (m_errorOccurred) {
-                    ImGui::Begin(m_error.type());
-                    ImGui::TextUnformatted(m_error.what());
+                if (m_error->occurred) {
+                    ImGui::Begin(m_error->exception.type());
+                    ImGui::TextUnformatted(m_error->exception.what());
                     if (ImGui::Button("Ok")) {
-                        m_errorOccurred = false;
+                        m_error->occurred = false;
                     }
                     ImGui::End();
                 }
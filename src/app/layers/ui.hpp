@@ -46,8 +46,12 @@ namespace tme {
                 void showShaderSelection(core::Handle<graphics::TileFactory> factory);
                 void showTextureSelection();
 
-                bool m_errorOccurred;
-                core::exceptions::Base m_error;
+                struct Error {
+                    bool occurred;
+                    core::exceptions::Base exception;
+                };
+                // shared with the callbacks of pending texture loads, which may finish after the layer has been deleted
+                core::Handle<Error> m_error;
                 void showErrors();
             };
 
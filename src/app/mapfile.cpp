@@ -0,0 +1,402 @@
+/** @file */
+
+#include "app/mapfile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "core/exceptions/input.hpp"
+#include "core/graphics/shader.hpp"
+#include "core/graphics/texture.hpp"
+#include "app/graphics/color.hpp"
+#include "app/graphics/texture.hpp"
+#include "app/layers/map.hpp"
+#include "app/tilemap.hpp"
+
+namespace tme {
+    namespace app {
+
+        static_assert(sizeof(MapFile::Header) == 96, "unexpected padding in MapFile::Header");
+        static_assert(sizeof(MapFile::LayerEntry) == 16, "unexpected padding in MapFile::LayerEntry");
+        static_assert(sizeof(MapFile::KindEntry) == 48, "unexpected padding in MapFile::KindEntry");
+        static_assert(sizeof(MapFile::FrameEntry) == 24, "unexpected padding in MapFile::FrameEntry");
+        static_assert(sizeof(MapFile::StringEntry) == 16, "unexpected padding in MapFile::StringEntry");
+
+        namespace {
+
+            constexpr char s_magic[4] = {'T', 'M', 'E', 'M'};
+
+            /**//**
+             * \brief Multiply two sizes unless the product does not fit.
+             *
+             * @param a first factor
+             * @param b second factor
+             * @param result product, only written if it fits
+             *
+             * @return false if the product overflows
+             */
+            inline bool multiply(uint64_t a, uint64_t b, uint64_t& result) {
+                if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a) {
+                    return false;
+                }
+                result = a * b;
+                return true;
+            }
+
+            inline uint64_t chunkBytes(uint32_t chunkSize) {
+                return static_cast<uint64_t>(chunkSize) * chunkSize * sizeof(TileGrid::Kind);
+            }
+
+            inline uint64_t chunksX(const MapFile::Header& header) {
+                return header.width / header.chunkSize + (header.width % header.chunkSize != 0);
+            }
+
+            inline uint64_t chunksY(const MapFile::Header& header) {
+                return header.height / header.chunkSize + (header.height % header.chunkSize != 0);
+            }
+
+            /**//**
+             * \brief Get the number of bytes of the chunks of a layer.
+             *
+             * @param header header with a non zero chunk size
+             * @param result number of bytes, only written if it fits
+             *
+             * @return false if the number of bytes overflows
+             */
+            inline bool layerBytes(const MapFile::Header& header, uint64_t& result) {
+                uint64_t chunkCount;
+                return multiply(chunksX(header), chunksY(header), chunkCount) && multiply(chunkCount, chunkBytes(header.chunkSize), result);
+            }
+
+            core::Identifier findShader(const std::string& vertexName, const std::string& vertexPath, const std::string& fragmentName, const std::string& fragmentPath) {
+                using Stage = core::graphics::Shader::Stage;
+                auto globalShaderStages = core::Storage<Stage>::global();
+                auto globalShaders = core::Storage<core::graphics::Shader>::global();
+                for (auto iter : *globalShaders) {
+                    auto shader = iter.second;
+                    auto vertex = globalShaderStages->get(shader->getStage(Stage::Type::Vertex));
+                    auto fragment = globalShaderStages->get(shader->getStage(Stage::Type::Fragment));
+                    if (vertex && fragment && vertex->getFilePath() == vertexPath && fragment->getFilePath() == fragmentPath) {
+                        return shader->getId();
+                    }
+                }
+                return globalShaders->create(
+                        globalShaderStages->create(Stage::Type::Vertex, vertexName, vertexPath),
+                        globalShaderStages->create(Stage::Type::Fragment, fragmentName, fragmentPath)
+                        )->getId();
+            }
+
+            core::Identifier findTexture(const std::string& filePath) {
+                auto globalTextures = core::Storage<core::graphics::Texture>::global();
+                for (auto iter : *globalTextures) {
+                    if (iter.second->getFilePath() == filePath) {
+                        return iter.second->getId();
+                    }
+                }
+                return globalTextures->create(filePath)->getId();
+            }
+
+        }
+
+        MapFile::MapFile(const std::string& filePath) : m_filePath(filePath), m_data(nullptr), m_size(0) {
+            int fd = open(filePath.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw core::exceptions::InvalidInput("could not open tilemap file");
+            }
+            struct stat status;
+            if (fstat(fd, &status) != 0 || static_cast<uint64_t>(status.st_size) < sizeof(Header)) {
+                close(fd);
+                throw core::exceptions::InvalidInput("tilemap file is too small");
+            }
+            m_size = static_cast<size_t>(status.st_size);
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED) {
+                throw core::exceptions::InvalidInput("could not map tilemap file");
+            }
+            m_data = static_cast<const char*>(data);
+            try {
+                validate();
+            } catch(...) {
+                munmap(const_cast<char*>(m_data), m_size);
+                throw;
+            }
+            TME_INFO("created {}", *this);
+        }
+
+        MapFile::~MapFile() {
+            TME_INFO("deleting {}", *this);
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+
+        void MapFile::validate() const {
+            const Header& header = getHeader();
+            auto fits = [this](uint64_t offset, uint64_t count, uint64_t entrySize, uint64_t alignment) {
+                return offset % alignment == 0 && offset <= m_size && count <= (m_size - offset) / entrySize;
+            };
+
+            if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0) {
+                throw core::exceptions::InvalidInput("not a tilemap file");
+            }
+            if (header.version != VERSION) {
+                throw core::exceptions::InvalidInput("unsupported tilemap file version");
+            }
+            if (header.chunkSize != layers::MapLayer::getChunkSize()) {
+                throw core::exceptions::InvalidInput("unsupported chunk size in tilemap file");
+            }
+            if (header.width == 0 || header.width > MAX_DIMENSION || header.height == 0 || header.height > MAX_DIMENSION) {
+                throw core::exceptions::InvalidInput("invalid dimensions in tilemap file");
+            }
+            uint64_t bytesPerLayer;
+            if (!layerBytes(header, bytesPerLayer)) {
+                throw core::exceptions::InvalidInput("tilemap file is too large");
+            }
+            if (!fits(header.layerTable, header.layerCount, sizeof(LayerEntry), alignof(LayerEntry))
+                || !fits(header.kindTable, header.kindCount, sizeof(KindEntry), alignof(KindEntry))
+                || !fits(header.frameTable, header.frameCount, sizeof(FrameEntry), alignof(FrameEntry))
+                || !fits(header.stringTable, header.stringCount, sizeof(StringEntry), alignof(StringEntry))) {
+                throw core::exceptions::InvalidInput("table outside of tilemap file");
+            }
+
+            const auto* strings = table<StringEntry>(header.stringTable);
+            for (uint32_t i = 0; i < header.stringCount; ++i) {
+                if (!fits(strings[i].offset, strings[i].length, 1, 1)) {
+                    throw core::exceptions::InvalidInput("string outside of tilemap file");
+                }
+            }
+
+            const auto* kinds = table<KindEntry>(header.kindTable);
+            for (uint32_t i = 0; i < header.kindCount; ++i) {
+                const KindEntry& kind = kinds[i];
+                if (kind.vertexName >= header.stringCount || kind.vertexPath >= header.stringCount
+                    || kind.fragmentName >= header.stringCount || kind.fragmentPath >= header.stringCount) {
+                    throw core::exceptions::InvalidInput("unknown shader in tilemap file");
+                }
+                if (kind.type == TileType::Texture) {
+                    if (kind.texture >= header.stringCount) {
+                        throw core::exceptions::InvalidInput("unknown texture in tilemap file");
+                    }
+                    if (kind.frameCount == 0 || static_cast<uint64_t>(kind.firstFrame) + kind.frameCount > header.frameCount) {
+                        throw core::exceptions::InvalidInput("invalid frames in tilemap file");
+                    }
+                } else if (kind.type != TileType::Color) {
+                    throw core::exceptions::InvalidInput("unknown tile type in tilemap file");
+                }
+            }
+
+            const auto* layers = table<LayerEntry>(header.layerTable);
+            for (uint32_t i = 0; i < header.layerCount; ++i) {
+                const LayerEntry& layer = layers[i];
+                if (static_cast<uint64_t>(layer.firstKind) + layer.kindCount > header.kindCount || layer.kindCount > std::numeric_limits<TileGrid::Kind>::max()) {
+                    throw core::exceptions::InvalidInput("invalid kinds in tilemap file");
+                }
+                if (!fits(layer.chunks, bytesPerLayer, 1, alignof(TileGrid::Kind))) {
+                    throw core::exceptions::InvalidInput("chunks outside of tilemap file");
+                }
+            }
+        }
+
+        void MapFile::write(const std::string& filePath, const Tilemap& tilemap) {
+            const uint32_t chunkSize = layers::MapLayer::getChunkSize();
+            if (tilemap.getWidth() == 0 || tilemap.getWidth() > MAX_DIMENSION || tilemap.getHeight() == 0 || tilemap.getHeight() > MAX_DIMENSION) {
+                throw core::exceptions::InvalidInput("tilemap dimensions can not be stored");
+            }
+
+            std::vector<LayerEntry> layerTable;
+            std::vector<KindEntry> kindTable;
+            std::vector<FrameEntry> frameTable;
+            std::vector<std::string> strings;
+            std::unordered_map<std::string, uint32_t> stringIndices;
+            auto addString = [&strings, &stringIndices](const std::string& string) {
+                auto [iter, inserted] = stringIndices.insert({string, static_cast<uint32_t>(strings.size())});
+                if (inserted) {
+                    strings.push_back(string);
+                }
+                return iter->second;
+            };
+
+            using Stage = core::graphics::Shader::Stage;
+            auto globalShaderStages = core::Storage<Stage>::global();
+            auto globalShaders = core::Storage<core::graphics::Shader>::global();
+            auto globalTextures = core::Storage<core::graphics::Texture>::global();
+            for (size_t i = 0; i < tilemap.getLayerCount(); ++i) {
+                const TileGrid& grid = tilemap.getLayer(i).getTiles();
+                layerTable.push_back({0, static_cast<uint32_t>(kindTable.size()), static_cast<uint32_t>(grid.getKindCount())});
+                for (size_t kind = TileGrid::EMPTY + 1; kind <= grid.getKindCount(); ++kind) {
+                    auto prototype = grid.getPrototype(static_cast<TileGrid::Kind>(kind));
+                    auto shader = globalShaders->get(prototype->getShader());
+                    if (!shader) {
+                        throw core::exceptions::InvalidInput("tile uses an unknown shader");
+                    }
+                    auto vertex = globalShaderStages->get(shader->getStage(Stage::Type::Vertex));
+                    auto fragment = globalShaderStages->get(shader->getStage(Stage::Type::Fragment));
+
+                    KindEntry entry{};
+                    entry.vertexName = addString(vertex->getName());
+                    entry.vertexPath = addString(vertex->getFilePath());
+                    entry.fragmentName = addString(fragment->getName());
+                    entry.fragmentPath = addString(fragment->getFilePath());
+                    entry.texture = NO_STRING;
+                    if (const auto* color = dynamic_cast<const graphics::ColorTile*>(prototype.get()); color) {
+                        entry.type = TileType::Color;
+                        glm::vec4 value = color->getColor();
+                        entry.color[0] = value.r;
+                        entry.color[1] = value.g;
+                        entry.color[2] = value.b;
+                        entry.color[3] = value.a;
+                    } else if (const auto* texture = dynamic_cast<const graphics::TextureTile*>(prototype.get()); texture) {
+                        auto globalTexture = globalTextures->get(texture->getTexture());
+                        if (!globalTexture) {
+                            throw core::exceptions::InvalidInput("tile uses an unknown texture");
+                        }
+                        entry.type = TileType::Texture;
+                        entry.texture = addString(globalTexture->getFilePath());
+                        entry.firstFrame = static_cast<uint32_t>(frameTable.size());
+                        entry.frameCount = static_cast<uint32_t>(texture->getFrames().size());
+                        for (const auto& frame : texture->getFrames()) {
+                            frameTable.push_back({frame.time, {frame.texPos.x, frame.texPos.y, frame.texPos.z, frame.texPos.w}});
+                        }
+                    } else {
+                        throw core::exceptions::InvalidInput("tile type can not be stored");
+                    }
+                    kindTable.push_back(entry);
+                }
+            }
+
+            Header header{};
+            std::memcpy(header.magic, s_magic, sizeof(s_magic));
+            header.version = VERSION;
+            header.width = tilemap.getWidth();
+            header.height = tilemap.getHeight();
+            header.tileSize = tilemap.getTileSize();
+            header.chunkSize = chunkSize;
+            header.layerCount = static_cast<uint32_t>(layerTable.size());
+            header.kindCount = static_cast<uint32_t>(kindTable.size());
+            header.frameCount = static_cast<uint32_t>(frameTable.size());
+            header.stringCount = static_cast<uint32_t>(strings.size());
+            if (auto background = tilemap.getBackground(); background) {
+                glm::vec4 color = background->getColor();
+                header.hasBackground = 1;
+                header.background[0] = color.r;
+                header.background[1] = color.g;
+                header.background[2] = color.b;
+                header.background[3] = color.a;
+            }
+            header.layerTable = sizeof(Header);
+            header.kindTable = header.layerTable + layerTable.size() * sizeof(LayerEntry);
+            header.frameTable = header.kindTable + kindTable.size() * sizeof(KindEntry);
+            header.stringTable = header.frameTable + frameTable.size() * sizeof(FrameEntry);
+
+            std::vector<StringEntry> stringTable;
+            uint64_t offset = header.stringTable + strings.size() * sizeof(StringEntry);
+            for (const auto& string : strings) {
+                stringTable.push_back({offset, static_cast<uint32_t>(string.size()), 0});
+                offset += string.size();
+            }
+            // chunks start 8 byte aligned
+            uint64_t padding = (8 - offset % 8) % 8;
+            offset += padding;
+            // can not overflow for dimensions up to MAX_DIMENSION
+            uint64_t bytesPerLayer = 0;
+            layerBytes(header, bytesPerLayer);
+            for (auto& layer : layerTable) {
+                layer.chunks = offset;
+                offset += bytesPerLayer;
+            }
+
+            // the file may still be mapped to stream its chunks, so it is replaced instead of overwritten
+            std::string tempPath = filePath + ".tmp";
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                throw core::exceptions::InvalidInput("could not create tilemap file");
+            }
+            auto writeTable = [&file](const auto& entries) {
+                file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(entries[0])));
+            };
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writeTable(layerTable);
+            writeTable(kindTable);
+            writeTable(frameTable);
+            writeTable(stringTable);
+            for (const auto& string : strings) {
+                file.write(string.data(), static_cast<std::streamsize>(string.size()));
+            }
+            const char zeros[8] = {};
+            file.write(zeros, static_cast<std::streamsize>(padding));
+
+            std::vector<TileGrid::Kind> chunk(static_cast<size_t>(chunkSize) * chunkSize);
+            for (size_t i = 0; i < tilemap.getLayerCount(); ++i) {
+                const auto& layer = tilemap.getLayer(i);
+                size_t chunkCount = static_cast<size_t>(layer.getTiles().getChunksX()) * layer.getTiles().getChunksY();
+                for (size_t index = 0; index < chunkCount; ++index) {
+                    layer.readChunk(index, chunk.data());
+                    writeTable(chunk);
+                }
+            }
+            file.close();
+            if (!file || std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+                std::remove(tempPath.c_str());
+                throw core::exceptions::InvalidInput("could not write tilemap file");
+            }
+            TME_INFO("wrote tilemap {} with {} layers to {}", tilemap.getId(), header.layerCount, filePath);
+        }
+
+        const TileGrid::Kind* MapFile::getChunk(size_t layer, uint32_t x, uint32_t y) const {
+            const Header& header = getHeader();
+            TME_ASSERT(layer < header.layerCount, "layer outside of the tilemap file");
+            TME_ASSERT(x < chunksX(header) && y < chunksY(header), "chunk outside of the tilemap file");
+            // validated to be within the layer, which fits into the file
+            uint64_t offset = table<LayerEntry>(header.layerTable)[layer].chunks + (y * chunksX(header) + x) * chunkBytes(header.chunkSize);
+            return table<TileGrid::Kind>(offset);
+        }
+
+        std::vector<core::Handle<graphics::Tile>> MapFile::createPrototypes(size_t layer) const {
+            const Header& header = getHeader();
+            TME_ASSERT(layer < header.layerCount, "layer outside of the tilemap file");
+            // make sure tiles using the default shaders share them with newly created tiles
+            graphics::ColorTile::createDefaultShader();
+            graphics::TextureTile::createDefaultShader();
+
+            const LayerEntry& entry = table<LayerEntry>(header.layerTable)[layer];
+            const auto* kinds = table<KindEntry>(header.kindTable) + entry.firstKind;
+            const auto* frames = table<FrameEntry>(header.frameTable);
+            std::vector<core::Handle<graphics::Tile>> prototypes;
+            prototypes.reserve(entry.kindCount);
+            for (uint32_t i = 0; i < entry.kindCount; ++i) {
+                const KindEntry& kind = kinds[i];
+                core::Identifier shaderId = findShader(getString(kind.vertexName), getString(kind.vertexPath), getString(kind.fragmentName), getString(kind.fragmentPath));
+                if (kind.type == TileType::Color) {
+                    glm::vec4 color(kind.color[0], kind.color[1], kind.color[2], kind.color[3]);
+                    prototypes.emplace_back(new graphics::ColorTile(graphics::Tile::generateId(0, 0), 0, 0, shaderId, color));
+                    continue;
+                }
+                graphics::TextureTile::Frames tileFrames;
+                for (uint32_t frame = kind.firstFrame; frame < kind.firstFrame + kind.frameCount; ++frame) {
+                    const float* texPos = frames[frame].texPos;
+                    tileFrames.push_back({frames[frame].time, glm::vec4(texPos[0], texPos[1], texPos[2], texPos[3])});
+                }
+                core::Identifier textureId = findTexture(getString(kind.texture));
+                prototypes.emplace_back(new graphics::TextureTile(graphics::Tile::generateId(0, 0), 0, 0, shaderId, textureId, tileFrames));
+            }
+            return prototypes;
+        }
+
+        std::string MapFile::getString(uint32_t index) const {
+            const StringEntry& entry = table<StringEntry>(getHeader().stringTable)[index];
+            return std::string(m_data + entry.offset, entry.length);
+        }
+
+        std::string MapFile::toString() const {
+            std::stringstream ss;
+            ss << "MapFile(" << m_filePath << ',' << m_size << ')';
+            return ss.str();
+        }
+
+    }
+}
@@ -0,0 +1,220 @@
+#ifndef _APP_MAPFILE_H
+#define _APP_MAPFILE_H
+/** @file */
+
+#include <string>
+#include <vector>
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+#include "app/graphics/tile.hpp"
+#include "app/tilegrid.hpp"
+
+namespace tme {
+    namespace app {
+
+        class Tilemap;
+
+        /**//**
+         * \brief Memory mapped view of a binary tilemap file.
+         *
+         * The file consists of a Header followed by tables referenced through byte offsets
+         * stored in the header:
+         * - a LayerEntry per layer,
+         * - a KindEntry per tile kind, each layer owns a contiguous range of them,
+         * - a FrameEntry per animation frame, each textured kind owns a contiguous range of them,
+         * - a StringEntry per referenced shader stage or texture together with the characters.
+         *
+         * The tiles of a layer are stored as fixed size chunks of TileGrid::Kind in row major order,
+         * which are themselves stored in row major order. A kind k > 0 of a layer refers to the kind entry
+         * firstKind + k - 1 of that layer, so the chunks can be copied into a TileGrid as they are.
+         * All values are stored in the byte order of the machine writing the file.
+         */
+        class MapFile final : public core::Loggable {
+            public:
+            /// current version of the format
+            static constexpr uint32_t VERSION = 1;
+            /// string index indicating that a string is not set
+            static constexpr uint32_t NO_STRING = static_cast<uint32_t>(-1);
+            /// largest number of tiles in each direction
+            static constexpr uint32_t MAX_DIMENSION = 1u << 16;
+
+            /**//**
+             * \brief Type of the tiles of a kind.
+             */
+            enum class TileType : uint32_t {
+                Color = 0,
+                Texture = 1,
+            };
+
+            /**//**
+             * \brief Start of the file.
+             */
+            struct Header {
+                /// always "TMEM"
+                char magic[4];
+                /// version of the format, has to be VERSION
+                uint32_t version;
+                /// number of tiles in x direction
+                uint32_t width;
+                /// number of tiles in y direction
+                uint32_t height;
+                /// size of a tile dimension in pixels
+                uint32_t tileSize;
+                /// number of tiles in each direction of a chunk
+                uint32_t chunkSize;
+                /// number of entries in the layer table
+                uint32_t layerCount;
+                /// number of entries in the kind table
+                uint32_t kindCount;
+                /// number of entries in the frame table
+                uint32_t frameCount;
+                /// number of entries in the string table
+                uint32_t stringCount;
+                /// 1 if the map has a background, 0 otherwise
+                uint32_t hasBackground;
+                /// padding, always 0
+                uint32_t reserved;
+                /// color of the background
+                float background[4];
+                /// byte offset of the layer table
+                uint64_t layerTable;
+                /// byte offset of the kind table
+                uint64_t kindTable;
+                /// byte offset of the frame table
+                uint64_t frameTable;
+                /// byte offset of the string table
+                uint64_t stringTable;
+            };
+
+            /**//**
+             * \brief A single layer.
+             */
+            struct LayerEntry {
+                /// byte offset of the first chunk of the layer
+                uint64_t chunks;
+                /// index of the kind entry of the first kind of the layer
+                uint32_t firstKind;
+                /// number of kinds of the layer
+                uint32_t kindCount;
+            };
+
+            /**//**
+             * \brief Prototype of the tiles of a kind.
+             */
+            struct KindEntry {
+                /// type of the tiles
+                TileType type;
+                /// string index of the name of the vertex shader stage
+                uint32_t vertexName;
+                /// string index of the file path of the vertex shader stage
+                uint32_t vertexPath;
+                /// string index of the name of the fragment shader stage
+                uint32_t fragmentName;
+                /// string index of the file path of the fragment shader stage
+                uint32_t fragmentPath;
+                /// string index of the file path of the texture, NO_STRING for colored tiles
+                uint32_t texture;
+                /// color of colored tiles
+                float color[4];
+                /// index of the frame entry of the first frame of textured tiles
+                uint32_t firstFrame;
+                /// number of frames of textured tiles
+                uint32_t frameCount;
+            };
+
+            /**//**
+             * \brief A single animation frame.
+             */
+            struct FrameEntry {
+                /// duration of the frame in seconds
+                double time;
+                /// normalised coordinates on the texture
+                float texPos[4];
+            };
+
+            /**//**
+             * \brief Location of a string inside the file.
+             */
+            struct StringEntry {
+                /// byte offset of the first character
+                uint64_t offset;
+                /// number of characters, the string is not null terminated
+                uint32_t length;
+                /// padding, always 0
+                uint32_t reserved;
+            };
+
+            private:
+            std::string m_filePath;
+            const char* m_data;
+            size_t m_size;
+
+            public:
+            /**//**
+             * \brief Map a tilemap file into memory.
+             *
+             * Validates the header and all tables, the chunks are only checked to be within the file.
+             *
+             * @param filePath path to the file
+             *
+             * @throw InvalidInput when the file can not be mapped or is not a valid tilemap file of this version
+             */
+            MapFile(const std::string& filePath);
+            ~MapFile();
+
+            MapFile(const MapFile&) = delete;
+            MapFile& operator=(const MapFile&) = delete;
+
+            /**//**
+             * \brief Write a Tilemap to a file.
+             *
+             * @param filePath path to the file, it is replaced if it already exists
+             * @param tilemap the Tilemap to be written
+             *
+             * @throw InvalidInput when the file can not be written or the Tilemap exceeds MAX_DIMENSION
+             */
+            static void write(const std::string& filePath, const Tilemap& tilemap);
+
+            /**//**
+             * \brief Get header of the file.
+             *
+             * @return reference to the mapped header
+             */
+            inline const Header& getHeader() const { return *reinterpret_cast<const Header*>(m_data); }
+            /**//**
+             * \brief Get a chunk of a layer.
+             *
+             * @param layer index of the layer
+             * @param x position of the chunk in x direction in full chunks
+             * @param y position of the chunk in y direction in full chunks
+             *
+             * @return pointer to the chunkSize * chunkSize kinds of the chunk inside the mapping
+             */
+            const TileGrid::Kind* getChunk(size_t layer, uint32_t x, uint32_t y) const;
+            /**//**
+             * \brief Create the prototypes of the kinds of a layer.
+             *
+             * Shaders and textures are looked up in the global storages by their file paths
+             * and created if they do not exist yet.
+             *
+             * @param layer index of the layer
+             *
+             * @throw InvalidInput when a shader or texture can not be created
+             *
+             * @return prototype per kind of the layer, the prototype of kind k is at index k - 1
+             */
+            std::vector<core::Handle<graphics::Tile>> createPrototypes(size_t layer) const;
+
+            std::string toString() const override;
+
+            private:
+            template<typename T>
+            inline const T* table(uint64_t offset) const { return reinterpret_cast<const T*>(m_data + offset); }
+            std::string getString(uint32_t index) const;
+            void validate() const;
+        };
+
+    }
+}
+
+#endif
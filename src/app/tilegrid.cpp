@@ -0,0 +1,177 @@
+/** @file */
+
+#include "app/tilegrid.hpp"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include "core/exceptions/input.hpp"
+
+namespace tme {
+    namespace app {
+
+        TileGrid::TileGrid(uint32_t width, uint32_t height, uint32_t chunkSize)
+            : m_width(width),
+            m_height(height),
+            m_chunkSize(chunkSize),
+            m_chunksX(width / chunkSize + (width % chunkSize != 0)),
+            m_chunksY(height / chunkSize + (height % chunkSize != 0)),
+            m_count(0),
+            m_chunks(static_cast<size_t>(m_chunksX) * m_chunksY),
+            m_chunkCounts(m_chunks.size(), 0),
+            m_palette(1),
+            m_kinds(),
+            m_animatedCells(1) {
+            TME_INFO("created {}", *this);
+        }
+
+        TileGrid::~TileGrid() {
+            TME_INFO("deleting {}", *this);
+        }
+
+        TileGrid::Kind TileGrid::addKind(core::Handle<graphics::Tile> tile) {
+            size_t hash = tile->hash();
+            auto [iter, end] = m_kinds.equal_range(hash);
+            for (; iter != end; ++iter) {
+                if (m_palette[iter->second]->matches(*tile)) {
+                    return iter->second;
+                }
+            }
+            if (m_palette.size() > std::numeric_limits<Kind>::max()) {
+                throw core::exceptions::InvalidInput("too many different tiles in one layer");
+            }
+            Kind kind = static_cast<Kind>(m_palette.size());
+            m_palette.push_back(tile);
+            m_animatedCells.emplace_back();
+            m_kinds.insert({hash, kind});
+            return kind;
+        }
+
+        void TileGrid::set(uint32_t x, uint32_t y, Kind kind) {
+            TME_ASSERT(x < m_width && y < m_height, "tile position outside of the grid");
+            TME_ASSERT(kind != EMPTY && kind < m_palette.size(), "unknown tile kind");
+            erase(x, y);
+            size_t chunk = getChunkIndex(x, y);
+            if (!m_chunks[chunk]) {
+                m_chunks[chunk] = Chunk(new Kind[static_cast<size_t>(m_chunkSize) * m_chunkSize]());
+            }
+            m_chunks[chunk][chunkOffset(x, y)] = kind;
+            if (m_palette[kind]->isAnimated()) {
+                auto& cells = m_animatedCells[kind];
+                cells.insert(std::lower_bound(cells.begin(), cells.end(), index(x, y)), index(x, y));
+            }
+            ++m_chunkCounts[chunk];
+            ++m_count;
+        }
+
+        void TileGrid::erase(uint32_t x, uint32_t y) {
+            if (!has(x, y)) {
+                return;
+            }
+            size_t chunk = getChunkIndex(x, y);
+            Kind& kind = m_chunks[chunk][chunkOffset(x, y)];
+            auto& cells = m_animatedCells[kind];
+            if (auto cell = std::lower_bound(cells.begin(), cells.end(), index(x, y)); cell != cells.end() && *cell == index(x, y)) {
+                cells.erase(cell);
+            }
+            kind = EMPTY;
+            --m_count;
+            if (--m_chunkCounts[chunk] == 0) {
+                m_chunks[chunk].reset();
+            }
+        }
+
+        bool TileGrid::has(uint32_t x, uint32_t y) const {
+            if (x >= m_width || y >= m_height) {
+                return false;
+            }
+            const Kind* kinds = m_chunks[getChunkIndex(x, y)].get();
+            return kinds && kinds[chunkOffset(x, y)] != EMPTY;
+        }
+
+        graphics::PlacedTile TileGrid::get(uint32_t x, uint32_t y) const {
+            TME_ASSERT(has(x, y), "cell does not contain a tile");
+            return graphics::PlacedTile(m_palette[m_chunks[getChunkIndex(x, y)][chunkOffset(x, y)]], x, y);
+        }
+
+        size_t TileGrid::setChunk(size_t chunk, Chunk kinds) {
+            clearChunk(chunk);
+            if (!kinds) {
+                return 0;
+            }
+            uint32_t firstX = static_cast<uint32_t>(chunk % m_chunksX) * m_chunkSize;
+            uint32_t firstY = static_cast<uint32_t>(chunk / m_chunksX) * m_chunkSize;
+            uint32_t count = 0;
+            size_t offset = 0;
+            for (uint32_t y = firstY; y < firstY + m_chunkSize; ++y) {
+                for (uint32_t x = firstX; x < firstX + m_chunkSize; ++x, ++offset) {
+                    Kind kind = kinds[offset];
+                    if (kind == EMPTY) {
+                        continue;
+                    }
+                    if (kind >= m_palette.size() || x >= m_width || y >= m_height) {
+                        throw core::exceptions::InvalidInput("invalid tile kind in chunk");
+                    }
+                    ++count;
+                }
+            }
+            // the cells of a chunk are merged into the index of each kind at once
+            std::vector<std::pair<Kind, size_t>> animatedCells;
+            collectAnimatedCells(chunk, kinds.get(), animatedCells);
+            for (auto begin = animatedCells.begin(); begin != animatedCells.end();) {
+                auto end = std::find_if(begin, animatedCells.end(), [begin](const auto& cell) { return cell.first != begin->first; });
+                auto& cells = m_animatedCells[begin->first];
+                size_t previous = cells.size();
+                std::transform(begin, end, std::back_inserter(cells), [](const auto& cell) { return cell.second; });
+                std::inplace_merge(cells.begin(), cells.begin() + static_cast<std::ptrdiff_t>(previous), cells.end());
+                begin = end;
+            }
+            if (count > 0) {
+                m_chunks[chunk] = std::move(kinds);
+                m_chunkCounts[chunk] = count;
+                m_count += count;
+            }
+            return count;
+        }
+
+        void TileGrid::clearChunk(size_t chunk) {
+            if (!m_chunks[chunk]) {
+                return;
+            }
+            std::vector<std::pair<Kind, size_t>> animatedCells;
+            collectAnimatedCells(chunk, m_chunks[chunk].get(), animatedCells);
+            for (auto begin = animatedCells.begin(); begin != animatedCells.end();) {
+                auto end = std::find_if(begin, animatedCells.end(), [begin](const auto& cell) { return cell.first != begin->first; });
+                auto& cells = m_animatedCells[begin->first];
+                cells.erase(std::remove_if(cells.begin(), cells.end(), [begin, end](size_t cell) {
+                    return std::binary_search(begin, end, std::make_pair(begin->first, cell));
+                }), cells.end());
+                begin = end;
+            }
+            m_count -= m_chunkCounts[chunk];
+            m_chunkCounts[chunk] = 0;
+            m_chunks[chunk].reset();
+        }
+
+        void TileGrid::collectAnimatedCells(size_t chunk, const Kind* kinds, std::vector<std::pair<Kind, size_t>>& cells) const {
+            uint32_t firstX = static_cast<uint32_t>(chunk % m_chunksX) * m_chunkSize;
+            uint32_t firstY = static_cast<uint32_t>(chunk / m_chunksX) * m_chunkSize;
+            size_t cellCount = static_cast<size_t>(m_chunkSize) * m_chunkSize;
+            for (size_t offset = 0; offset < cellCount; ++offset) {
+                if (kinds[offset] != EMPTY && m_palette[kinds[offset]]->isAnimated()) {
+                    uint32_t x = firstX + static_cast<uint32_t>(offset % m_chunkSize);
+                    uint32_t y = firstY + static_cast<uint32_t>(offset / m_chunkSize);
+                    cells.push_back({kinds[offset], index(x, y)});
+                }
+            }
+            std::sort(cells.begin(), cells.end());
+        }
+
+        std::string TileGrid::toString() const {
+            std::stringstream ss;
+            ss << "TileGrid(" << m_width << ',' << m_height << ',' << m_chunkSize << ',' << m_count << ',' << m_palette.size() - 1 << ')';
+            return ss.str();
+        }
+
+    }
+}
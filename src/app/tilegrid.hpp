@@ -0,0 +1,288 @@
+#ifndef _APP_TILEGRID_H
+#define _APP_TILEGRID_H
+/** @file */
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+#include "app/graphics/tile.hpp"
+
+namespace tme {
+    namespace app {
+
+        /**//**
+         * \brief Chunked storage for the tiles of a single map layer.
+         *
+         * Instead of storing a Tile object per cell, matching tiles share a prototype Tile in a palette.
+         * Every cell only stores the index of its prototype (its kind). The grid is split into square chunks,
+         * each storing the kinds of its cells in a contiguous row major array. Chunks without tiles
+         * do not allocate any memory, so a chunk can be dropped and loaded again as a whole.
+         * get() places the prototype at the cell through a PlacedTile, which is the Batchable for that cell.
+         * The palette is indexed by the hash of the prototypes, so finding the kind of a tile does not scan it.
+         * Cells of animated kinds are additionally indexed per kind so
+         * they can be found without a scan when the animation of their kind advances.
+         */
+        class TileGrid final : public core::Loggable {
+            public:
+            /// index of a prototype inside the palette
+            using Kind = uint16_t;
+            /// kind of cells without a tile
+            static constexpr Kind EMPTY = 0;
+            /// owning pointer to the chunkSize * chunkSize kinds of a chunk
+            using Chunk = std::unique_ptr<Kind[]>;
+
+            private:
+            uint32_t m_width, m_height;
+            uint32_t m_chunkSize;
+            uint32_t m_chunksX, m_chunksY;
+            size_t m_count;
+            // row major, nullptr for chunks without tiles
+            std::vector<Chunk> m_chunks;
+            std::vector<uint32_t> m_chunkCounts;
+            // prototype per kind, the one at EMPTY is never set
+            std::vector<core::Handle<graphics::Tile>> m_palette;
+            // kinds by the hash of their prototype
+            std::unordered_multimap<size_t, Kind> m_kinds;
+            // sorted row major cell indices per kind, only filled for animated kinds
+            std::vector<std::vector<size_t>> m_animatedCells;
+
+            public:
+            /**//**
+             * \brief Construct empty TileGrid.
+             *
+             * @param width number of cells in the x direction
+             * @param height number of cells in the y direction
+             * @param chunkSize number of cells in each direction of a chunk
+             */
+            TileGrid(uint32_t width, uint32_t height, uint32_t chunkSize);
+            ~TileGrid();
+
+            /**//**
+             * \brief Get the kind matching a tile, adding the tile to the palette if none does.
+             *
+             * @param tile the Tile to find a kind for, its position is ignored
+             *
+             * @throw InvalidInput when the palette is full
+             *
+             * @return kind of the tile
+             */
+            Kind addKind(core::Handle<graphics::Tile> tile);
+
+            /**//**
+             * \brief Place a tile of a kind into a cell.
+             *
+             * Replaces the previous tile of the cell.
+             *
+             * @param x position of the cell in x direction
+             * @param y position of the cell in y direction
+             * @param kind kind of the tile as returned by addKind()
+             */
+            void set(uint32_t x, uint32_t y, Kind kind);
+            /**//**
+             * \brief Remove tile of a cell.
+             *
+             * Frees the chunk of the cell once it is empty.
+             *
+             * @param x position of the cell in x direction
+             * @param y position of the cell in y direction
+             */
+            void erase(uint32_t x, uint32_t y);
+            /**//**
+             * \brief Check if a cell contains a tile.
+             *
+             * @param x position of the cell in x direction
+             * @param y position of the cell in y direction
+             *
+             * @return true if the cell is within the grid and not empty
+             */
+            bool has(uint32_t x, uint32_t y) const;
+
+            /**//**
+             * \brief Get the tile of a non empty cell.
+             *
+             * The prototype of the cell's kind is placed at the cell without being modified.
+             * Returned by value, so filling a Batcher does not allocate per cell.
+             *
+             * @param x position of the cell in x direction
+             * @param y position of the cell in y direction
+             *
+             * @return the tile at the position
+             */
+            graphics::PlacedTile get(uint32_t x, uint32_t y) const;
+
+            /**//**
+             * \brief Get the kinds of a chunk.
+             *
+             * @param chunk row major index of the chunk
+             *
+             * @return pointer to the chunkSize * chunkSize row major kinds of the chunk, nullptr if it has no tiles
+             */
+            inline const Kind* getChunk(size_t chunk) const { return m_chunks[chunk].get(); }
+            /**//**
+             * \brief Replace all cells of a chunk.
+             *
+             * Takes over the array without copying it, cells of the chunk outside of the grid have to be EMPTY.
+             *
+             * @param chunk row major index of the chunk
+             * @param kinds chunkSize * chunkSize row major kinds as returned by addKind() or EMPTY
+             *
+             * @throw InvalidInput when a kind is not part of the palette or a cell outside the grid is not empty,
+             *        the chunk is left empty in that case
+             *
+             * @return number of non empty cells of the chunk
+             */
+            size_t setChunk(size_t chunk, Chunk kinds);
+            /**//**
+             * \brief Remove all tiles of a chunk.
+             *
+             * @param chunk row major index of the chunk
+             */
+            void clearChunk(size_t chunk);
+            /**//**
+             * \brief Get index of the chunk containing a cell.
+             *
+             * @param x position of the cell in x direction
+             * @param y position of the cell in y direction
+             *
+             * @return row major index of the chunk
+             */
+            inline size_t getChunkIndex(uint32_t x, uint32_t y) const { return static_cast<size_t>(y / m_chunkSize) * m_chunksX + x / m_chunkSize; }
+
+            /**//**
+             * \brief Call a function for every non empty cell.
+             *
+             * The chunks are visited in row major order, the cells of a chunk as well.
+             *
+             * @param callback function called with x, y and the kind of every non empty cell
+             */
+            template<typename F>
+            void forEach(F callback) const {
+                for (size_t chunk = 0; chunk < m_chunks.size(); ++chunk) {
+                    forEachInChunk(chunk, callback);
+                }
+            }
+            /**//**
+             * \brief Call a function for every non empty cell of a chunk.
+             *
+             * The cells are visited in row major order.
+             *
+             * @param chunk row major index of the chunk
+             * @param callback function called with x, y and the kind of every non empty cell
+             */
+            template<typename F>
+            void forEachInChunk(size_t chunk, F callback) const {
+                const Kind* kinds = m_chunks[chunk].get();
+                if (!kinds) {
+                    return;
+                }
+                uint32_t firstX = static_cast<uint32_t>(chunk % m_chunksX) * m_chunkSize;
+                uint32_t firstY = static_cast<uint32_t>(chunk / m_chunksX) * m_chunkSize;
+                for (uint32_t y = 0; y < m_chunkSize; ++y) {
+                    for (uint32_t x = 0; x < m_chunkSize; ++x, ++kinds) {
+                        if (*kinds != EMPTY) {
+                            callback(firstX + x, firstY + y, *kinds);
+                        }
+                    }
+                }
+            }
+
+            /**//**
+             * \brief Call a function for every cell of a kind.
+             *
+             * Cells of animated kinds are looked up directly, other kinds require a scan of the grid.
+             *
+             * @param kind kind of the cells to be visited
+             * @param callback function called with x and y of every cell of the kind
+             */
+            template<typename F>
+            void forEachOfKind(Kind kind, F callback) const {
+                if (m_palette[kind]->isAnimated()) {
+                    for (auto index : m_animatedCells[kind]) {
+                        callback(static_cast<uint32_t>(index % m_width), static_cast<uint32_t>(index / m_width));
+                    }
+                    return;
+                }
+                forEach([&callback, kind](uint32_t x, uint32_t y, Kind cellKind) {
+                    if (cellKind == kind) {
+                        callback(x, y);
+                    }
+                });
+            }
+
+            /**//**
+             * \brief Check if any cell contains a tile of an animated kind.
+             *
+             * @param kind kind as returned by addKind()
+             *
+             * @return true if the kind is animated and placed in at least one cell
+             */
+            inline bool hasAnimatedCells(Kind kind) const { return !m_animatedCells[kind].empty(); }
+
+            /**//**
+             * \brief Get prototype of a kind.
+             *
+             * @param kind kind as returned by addKind()
+             *
+             * @return Handle to the prototype Tile
+             */
+            inline core::Handle<graphics::Tile> getPrototype(Kind kind) const { return m_palette[kind]; }
+
+            /**//**
+             * \brief Get number of tiles.
+             *
+             * @return number of non empty cells
+             */
+            inline size_t getCount() const { return m_count; }
+            /**//**
+             * \brief Get number of kinds.
+             *
+             * @return number of prototypes in the palette, kinds range from 1 to this number
+             */
+            inline size_t getKindCount() const { return m_palette.size() - 1; }
+            /**//**
+             * \brief Get width of the grid.
+             *
+             * @return number of cells in the x direction
+             */
+            inline uint32_t getWidth() const { return m_width; }
+            /**//**
+             * \brief Get height of the grid.
+             *
+             * @return number of cells in the y direction
+             */
+            inline uint32_t getHeight() const { return m_height; }
+            /**//**
+             * \brief Get size of the chunks.
+             *
+             * @return number of cells in each direction of a chunk
+             */
+            inline uint32_t getChunkSize() const { return m_chunkSize; }
+            /**//**
+             * \brief Get number of chunks in x direction.
+             *
+             * @return number of chunks per row
+             */
+            inline uint32_t getChunksX() const { return m_chunksX; }
+            /**//**
+             * \brief Get number of chunks in y direction.
+             *
+             * @return number of chunks per column
+             */
+            inline uint32_t getChunksY() const { return m_chunksY; }
+
+            std::string toString() const override;
+
+            private:
+            inline size_t index(uint32_t x, uint32_t y) const { return static_cast<size_t>(y) * m_width + x; }
+            inline size_t chunkOffset(uint32_t x, uint32_t y) const { return static_cast<size_t>(y % m_chunkSize) * m_chunkSize + x % m_chunkSize; }
+            // collects the cells of animated kinds of a chunk as kind and row major index sorted by both
+            void collectAnimatedCells(size_t chunk, const Kind* kinds, std::vector<std::pair<Kind, size_t>>& cells) const;
+        };
+
+    }
+}
+
+#endif
@@ -1,15 +1,19 @@
 /** @file */
 
 #include "app/tilemap.hpp"
+#include <algorithm>
+#include <cmath>
 #include "core/storage.hpp"
 #include "core/exceptions/common.hpp"
 #include "core/graphics/shader.hpp"
 #include "core/graphics/texture.hpp"
 #include "app/graphics/tile.hpp"
 #include "app/graphics/color.hpp"
+#include "app/graphics/frames.hpp"
 #include "app/graphics/texture.hpp"
 #include "app/layers/background.hpp"
 #include "app/layers/map.hpp"
+#include "app/chunkloader.hpp"
 
 namespace tme {
     namespace app {
@@ -20,12 +24,45 @@ namespace tme {
             m_width(width),
             m_height(height),
             m_cursor(new Cursor()),
-            m_background(nullptr) {
+            m_viewport(new Viewport{0, 0, width, height}),
+            m_renderQueue(new core::graphics::RenderQueue()),
+            m_background(nullptr),
+            m_loader(nullptr) {
             addLayer();
         }
 
+        Tilemap::Tilemap(const std::string& filePath)
+            : m_tileSize(0),
+            m_width(0),
+            m_height(0),
+            m_cursor(new Cursor()),
+            m_viewport(new Viewport()),
+            m_renderQueue(new core::graphics::RenderQueue()),
+            m_background(nullptr),
+            m_loader(new ChunkLoader(filePath)) {
+            const auto& header = m_loader->getFile().getHeader();
+            m_tileSize = header.tileSize;
+            m_width = header.width;
+            m_height = header.height;
+            *m_viewport = {0, 0, m_width, m_height};
+            if (header.hasBackground) {
+                setBackground(glm::vec4(header.background[0], header.background[1], header.background[2], header.background[3]));
+            }
+            for (size_t layer = 0; layer < header.layerCount; ++layer) {
+                addLayer();
+                m_mapLayers.back()->stream(m_loader);
+            }
+            if (m_layerCount == 0) {
+                addLayer();
+            }
+        }
+
         Tilemap::~Tilemap() {}
 
+        void Tilemap::save(const std::string& filePath) const {
+            MapFile::write(filePath, *this);
+        }
+
         core::Identifier Tilemap::getId() const {
             return m_id;
         }
@@ -35,20 +72,43 @@ namespace tme {
         }
 
         void Tilemap::render() {
+            if (m_loader) {
+                ChunkLoader::Chunk chunk;
+                while (m_loader->poll(chunk)) {
+                    if (chunk.layer < m_mapLayers.size()) {
+                        m_mapLayers[chunk.layer]->receive(chunk);
+                    }
+                }
+            }
+            graphics::FrameTable::global().update();
             if (m_background) {
-                m_background->render();
+                m_background->submit(*m_renderQueue);
             }
             m_layers.render();
+            m_renderQueue->flush();
         }
 
         void Tilemap::addLayer() {
-            m_layers.push<layers::MapLayer>(m_layerCount++, m_width * m_height, m_cursor);
+            m_mapLayers.push_back(&m_layers.push<layers::MapLayer>(m_layerCount++, m_width, m_height, m_cursor, m_viewport, m_renderQueue));
         }
         void Tilemap::removeLayer() {
             m_layerCount--;
+            m_mapLayers.pop_back();
             m_layers.pop();
         }
 
+        void Tilemap::setViewport(const Camera& camera) {
+            // the view translates the map by the camera position
+            double minX = std::clamp(std::floor(-camera.getPosition().x), 0.0, static_cast<double>(m_width));
+            double minY = std::clamp(std::floor(-camera.getPosition().y), 0.0, static_cast<double>(m_height));
+            double maxX = std::clamp(std::ceil(camera.getDimensions().x - camera.getPosition().x), minX, static_cast<double>(m_width));
+            double maxY = std::clamp(std::ceil(camera.getDimensions().y - camera.getPosition().y), minY, static_cast<double>(m_height));
+            m_viewport->x = static_cast<uint32_t>(minX);
+            m_viewport->y = static_cast<uint32_t>(minY);
+            m_viewport->width = static_cast<uint32_t>(maxX - minX);
+            m_viewport->height = static_cast<uint32_t>(maxY - minY);
+        }
+
         void Tilemap::setBackground(glm::vec4 color) {
             m_background = core::Handle<layers::Background>(new layers::Background(m_width, m_height, color));
         }
@@ -2,17 +2,25 @@
 #define _APP_TILEMAP_H
 /** @file */
 
+#include <string>
 #include <vector>
 #include "app/layers/background.hpp"
+#include "app/camera.hpp"
 #include "core/storage.hpp"
 #include "core/events/handler.hpp"
 #include "core/graphics/common.hpp"
+#include "core/graphics/renderqueue.hpp"
 #include "core/layers/layer.hpp"
 #include "app/graphics/tile.hpp"
 
 namespace tme {
     namespace app {
 
+        namespace layers {
+            class MapLayer;
+        }
+        class ChunkLoader;
+
         /**//**
          * \brief Cursor of a Tilemap.
          *
@@ -33,10 +41,29 @@ namespace tme {
         };
 
 
+        /**//**
+         * \brief Visible area of a Tilemap.
+         *
+         * Stores the tiles currently visible through the Camera so only those need to be rendered.
+         * The area is clamped to the dimensions of the map.
+         */
+        struct Viewport {
+            /// first visible tile in x direction
+            uint32_t x = 0;
+            /// first visible tile in y direction
+            uint32_t y = 0;
+            /// number of visible tiles in x direction
+            uint32_t width = 0;
+            /// number of visible tiles in y direction
+            uint32_t height = 0;
+        };
+
+
         /**//**
          * \brief Tilemap with multiple layers which can be edited using its cursor.
          *
-         * Keeps track of the associated shader and texture ids, its layers and the cursor.
+         * Keeps track of the associated shader and texture ids, its layers, the cursor and the viewport.
+         * Maps opened from a file load the tiles of their layers around the viewport on demand.
          */
         class Tilemap final : public core::Mappable, public core::events::Handler, public core::graphics::Renderable {
             core::Identifier m_id;
@@ -44,8 +71,15 @@ namespace tme {
             uint32_t m_width, m_height;
             size_t m_layerCount = 0;
             core::layers::Stack m_layers;
+            // the MapLayers inside m_layers in the same order
+            std::vector<layers::MapLayer*> m_mapLayers;
             core::Handle<Cursor> m_cursor;
+            core::Handle<Viewport> m_viewport;
+            // collects the batches of the background and all layers every frame
+            core::Handle<core::graphics::RenderQueue> m_renderQueue;
             core::Handle<layers::Background> m_background;
+            // streams the layers of maps opened from a file
+            core::Handle<ChunkLoader> m_loader;
 
             public:
             /**//**
@@ -56,8 +90,27 @@ namespace tme {
              * @param tileSize size of a tile dimension in pixels
              */
             Tilemap(uint32_t width, uint32_t height, uint32_t tileSize);
+            /**//**
+             * \brief Construct Tilemap from a tilemap file.
+             *
+             * The file stays mapped while the Tilemap exists to load its chunks on demand.
+             *
+             * @param filePath path to a file written by save()
+             *
+             * @throw InvalidInput when the file can not be loaded
+             */
+            explicit Tilemap(const std::string& filePath);
             ~Tilemap();
 
+            /**//**
+             * \brief Write the Tilemap to a file.
+             *
+             * @param filePath path to the file, it is replaced if it already exists
+             *
+             * @throw InvalidInput when the file can not be written
+             */
+            void save(const std::string& filePath) const;
+
             core::Identifier getId() const override;
             void onEvent(core::events::Event& e) override;
             void render() override;
@@ -86,6 +139,21 @@ namespace tme {
              * @return Handle to the Cursor
              */
             inline core::Handle<Cursor> getCursor() const { return m_cursor; }
+            /**//**
+             * \brief Get Viewport of Tilemap.
+             *
+             * @return Handle to the Viewport
+             */
+            inline core::Handle<Viewport> getViewport() const { return m_viewport; }
+
+            /**//**
+             * \brief Update Viewport to the area visible through the camera.
+             *
+             * Should be called before rendering whenever the camera might have changed.
+             *
+             * @param camera the Camera used to render the map
+             */
+            void setViewport(const Camera& camera);
 
             /**//**
              * \brief Get number of layers.
@@ -93,6 +161,14 @@ namespace tme {
              * @return number of MapLayer in the Tilemap
              */
             size_t getLayerCount() const { return m_layerCount; }
+            /**//**
+             * \brief Get a MapLayer.
+             *
+             * @param layer index of the layer, has to be smaller than getLayerCount()
+             *
+             * @return reference to the MapLayer
+             */
+            inline const layers::MapLayer& getLayer(size_t layer) const { return *m_mapLayers[layer]; }
             /**//**
              * \brief Add MapLayer.
              */
@@ -108,6 +184,12 @@ namespace tme {
              * @param color the color the background should have
              */
             void setBackground(glm::vec4 color);
+            /**//**
+             * \brief Get background of the map.
+             *
+             * @return Handle to the Background, nullptr if none has been set
+             */
+            inline core::Handle<layers::Background> getBackground() const { return m_background; }
         };
 
     }
@@ -3,6 +3,9 @@
 
 #include "core/events/event.hpp"
 #include "core/events/window.hpp"
+#include "core/graphics/loader.hpp"
+#include "core/graphics/profiler.hpp"
+#include "core/graphics/state.hpp"
 #include "core/storage.hpp"
 #include "core/window.hpp"
 
@@ -29,18 +32,21 @@ namespace tme {
 
         void WindowApplication::run() {
             auto window = Storage<Window>::global()->get(m_window);
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            graphics::State::global().setBlend(true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
             while (m_running) {
                 ImGui_ImplOpenGL3_NewFrame();
                 ImGui::NewFrame();
+                graphics::Profiler::global().beginFrame();
                 window->update();
+                graphics::TextureLoader::global().update();
                 render();
                 if (auto imGuiDrawData = ImGui::GetDrawData(); imGuiDrawData) {
+                    graphics::Profiler::Scope scope("ImGui");
                     ImGui_ImplOpenGL3_RenderDrawData(imGuiDrawData);
                 }
                 ImGui::EndFrame();
+                graphics::Profiler::global().endFrame();
                 window->swapBuffer();
                 window->pollEvents();
             }
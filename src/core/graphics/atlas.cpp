@@ -0,0 +1,127 @@
+/** @file */
+#include "core/graphics/atlas.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            glm::vec4 Atlas::Region::map(glm::vec4 texPos) const {
+                return glm::vec4(x + texPos.x * width, y + texPos.y * height, x + texPos.z * width, y + texPos.w * height);
+            }
+
+            Atlas::Atlas(Texture::Dimension pageSize) : m_pageSize(pageSize), m_pages(), m_regions() {
+                GLint maxSize = 0;
+                glCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize));
+                if (maxSize > 0) {
+                    m_pageSize = std::min(m_pageSize, static_cast<Texture::Dimension>(maxSize));
+                }
+                TME_INFO("created {}", *this);
+            }
+
+            Atlas::~Atlas() {
+                TME_INFO("deleting {}", *this);
+            }
+
+            Atlas& Atlas::global() {
+                static Atlas atlas(4096);
+                return atlas;
+            }
+
+            const Atlas::Region* Atlas::add(const Texture& texture) {
+                if (auto region = find(texture); region) {
+                    return region;
+                }
+                // packing the placeholder would keep it on the page after the image is loaded
+                if (texture.isPending()) {
+                    return nullptr;
+                }
+                // pages would drop the mipmaps and convert the format
+                if (texture.getOptions().mipmaps || texture.getOptions().format != Texture::defaultOptions().format) {
+                    return nullptr;
+                }
+                Texture::Dimension width = texture.getWidth() + s_padding;
+                Texture::Dimension height = texture.getHeight() + s_padding;
+                if (width > m_pageSize || height > m_pageSize) {
+                    return nullptr;
+                }
+
+                Texture::Dimension x = 0, y = 0;
+                auto page = std::find_if(m_pages.begin(), m_pages.end(), [&](Page& candidate) {
+                    return allocate(candidate, width, height, x, y);
+                });
+                if (page == m_pages.end()) {
+                    m_pages.push_back({Handle<Texture>(new Texture(m_pageSize, m_pageSize)), {}, 0});
+                    page = m_pages.end() - 1;
+                    allocate(*page, width, height, x, y);
+                }
+
+                auto pixels = texture.getPixels();
+                page->texture->setPixels(x, y, texture.getWidth(), texture.getHeight(), pixels.data());
+                // the padding above and to the right belongs to the allocated area
+                std::vector<unsigned char> transparent(static_cast<size_t>(std::max(width, height)) * s_padding * 4, 0);
+                page->texture->setPixels(x, y + texture.getHeight(), width, s_padding, transparent.data());
+                page->texture->setPixels(x + texture.getWidth(), y, s_padding, texture.getHeight(), transparent.data());
+
+                float size = static_cast<float>(m_pageSize);
+                Region region;
+                region.page = page->texture->getId();
+                region.x = static_cast<float>(x) / size;
+                region.y = static_cast<float>(y) / size;
+                region.width = static_cast<float>(texture.getWidth()) / size;
+                region.height = static_cast<float>(texture.getHeight()) / size;
+                TME_INFO("packed {} into page {} at {},{}", texture, region.page, x, y);
+                return &m_regions.insert({texture.getUniqueId(), region}).first->second;
+            }
+
+            bool Atlas::allocate(Page& page, Texture::Dimension width, Texture::Dimension height, Texture::Dimension& x, Texture::Dimension& y) {
+                // lowest fitting shelf wastes the least space
+                Shelf* best = nullptr;
+                for (auto& shelf : page.shelves) {
+                    if (shelf.height >= height && shelf.nextX + width <= m_pageSize && (!best || shelf.height < best->height)) {
+                        best = &shelf;
+                    }
+                }
+                if (!best) {
+                    if (page.nextY + height > m_pageSize) {
+                        return false;
+                    }
+                    page.shelves.push_back({page.nextY, height, 0});
+                    page.nextY += height;
+                    best = &page.shelves.back();
+                }
+                x = best->nextX;
+                y = best->y;
+                best->nextX += width;
+                return true;
+            }
+
+            const Atlas::Region* Atlas::find(const Texture& texture) const {
+                auto iter = m_regions.find(texture.getUniqueId());
+                return iter != m_regions.end() ? &iter->second : nullptr;
+            }
+
+            Handle<Texture> Atlas::getPage(Identifier pageId) const {
+                for (const auto& page : m_pages) {
+                    if (page.texture->getId() == pageId) {
+                        return page.texture;
+                    }
+                }
+                return nullptr;
+            }
+
+            void Atlas::clear() {
+                m_regions.clear();
+                m_pages.clear();
+            }
+
+            std::string Atlas::toString() const {
+                std::stringstream ss;
+                ss << "Atlas(" << m_pageSize << ',' << m_pages.size() << ',' << m_regions.size() << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
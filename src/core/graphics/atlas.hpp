@@ -0,0 +1,140 @@
+#ifndef _CORE_GRAPHICS_ATLAS_H
+#define _CORE_GRAPHICS_ATLAS_H
+/** @file */
+
+#include <unordered_map>
+#include <vector>
+#include "core/graphics/texture.hpp"
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+#include "glm/vec4.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Packs textures into shared pages so they can be rendered with a single texture.
+             *
+             * Every page is a Texture of a fixed size, textures are packed into rows (shelves) of similar height.
+             * A texture is only packed once, later requests return the Region it has been packed to.
+             * Pages use the default Texture options, textures with other options are not packed.
+             * The pages are owned by the Atlas and are not part of the global Texture Storage.
+             */
+            class Atlas final : public Loggable {
+                public:
+                /**//**
+                 * \brief Location of a packed texture on a page.
+                 *
+                 * Coordinates are normalised to the page.
+                 */
+                struct Region {
+                    /// global id of the page Texture
+                    Identifier page = NO_TEXTURE;
+                    /// left edge on the page
+                    float x = 0.0f;
+                    /// bottom edge on the page
+                    float y = 0.0f;
+                    /// width on the page
+                    float width = 1.0f;
+                    /// height on the page
+                    float height = 1.0f;
+
+                    /**//**
+                     * \brief Convert texture coordinates of the packed texture to coordinates on the page.
+                     *
+                     * @param texPos normalised xMin, yMin, xMax, yMax on the packed texture
+                     *
+                     * @return normalised xMin, yMin, xMax, yMax on the page
+                     */
+                    glm::vec4 map(glm::vec4 texPos) const;
+                };
+
+                private:
+                struct Shelf {
+                    Texture::Dimension y, height, nextX;
+                };
+
+                struct Page {
+                    Handle<Texture> texture;
+                    std::vector<Shelf> shelves;
+                    Texture::Dimension nextY;
+                };
+
+                // free pixels around every texture so neighbours do not bleed into each other
+                static constexpr Texture::Dimension s_padding = 1;
+
+                Texture::Dimension m_pageSize;
+                std::vector<Page> m_pages;
+                // region per Texture::getUniqueId() of the packed texture, GL reuses the ids of deleted textures
+                std::unordered_map<Identifier, Region> m_regions;
+
+                public:
+                /**//**
+                 * \brief Construct Atlas without pages.
+                 *
+                 * @param pageSize width and height of a page in pixels, clamped to the maximum texture size
+                 */
+                Atlas(Texture::Dimension pageSize);
+                ~Atlas();
+
+                /**//**
+                 * \brief Get the shared Atlas.
+                 *
+                 * Its pages are released by graphics::cleanUp().
+                 *
+                 * @return reference to the Atlas used by the application
+                 */
+                static Atlas& global();
+
+                /**//**
+                 * \brief Pack a texture.
+                 *
+                 * Copies the content of the texture to a free area on a page, adding a page if necessary.
+                 * The padding around it is cleared, as the content of new pages is undefined.
+                 *
+                 * @param texture the Texture to be packed
+                 *
+                 * @return pointer to the Region of the texture, nullptr if the texture is larger than a page, still pending or uses other options than the pages
+                 */
+                const Region* add(const Texture& texture);
+                /**//**
+                 * \brief Get the Region of a packed texture.
+                 *
+                 * @param texture the packed Texture
+                 *
+                 * @return pointer to the Region of the texture, nullptr if the texture has not been packed
+                 */
+                const Region* find(const Texture& texture) const;
+                /**//**
+                 * \brief Get a page.
+                 *
+                 * @param pageId global id of the page as stored in a Region
+                 *
+                 * @return Handle to the page Texture, nullptr if no page has the id
+                 */
+                Handle<Texture> getPage(Identifier pageId) const;
+
+                /**//**
+                 * \brief Get number of pages.
+                 *
+                 * @return number of page textures
+                 */
+                inline size_t getPageCount() const { return m_pages.size(); }
+
+                /**//**
+                 * \brief Remove all pages and regions.
+                 */
+                void clear();
+
+                std::string toString() const override;
+
+                private:
+                bool allocate(Page& page, Texture::Dimension width, Texture::Dimension height, Texture::Dimension& x, Texture::Dimension& y);
+            };
+
+        }
+    }
+}
+
+#endif
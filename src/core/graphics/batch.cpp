@@ -1,9 +1,14 @@
 /** @file */
 #include "core/graphics/batch.hpp"
+#include <cstdint>
+#include <functional>
 #include <sstream>
 #include "core/graphics/vertex.hpp"
 #include "core/graphics/index.hpp"
+#include "core/graphics/profiler.hpp"
+#include "core/graphics/renderqueue.hpp"
 #include "core/graphics/shader.hpp"
+#include "core/graphics/state.hpp"
 #include "core/graphics/texture.hpp"
 #include "core/exceptions/input.hpp"
 #include "core/exceptions/graphics.hpp"
@@ -37,44 +42,113 @@ namespace tme {
                 return ss.str();
             }
 
-            Batch::Config::Config(const Vertex& vertexDefinition, const Index& indexDefinition, void (*preRenderHook)(Identifier, Identifier), Identifier shader, Identifier texture)
-                : vertex(vertexDefinition), index(indexDefinition), shaderId(shader), textureId(texture), preRender(preRenderHook) {}
+            Batch::Config::Config(const Vertex& vertexDefinition, const Index& indexDefinition, void (*preRenderHook)(Identifier, Identifier), Identifier shader, Identifier texture, bool instancedRendering)
+                : vertex(vertexDefinition), index(indexDefinition), shaderId(shader), textureId(texture), preRender(preRenderHook), instanced(instancedRendering) {}
 
             bool Batch::Config::operator==(const Batch::Config& other) const {
-                return this->shaderId == other.shaderId && this->textureId == other.textureId && this->vertex == other.vertex && this->index == other.index;
+                return this->shaderId == other.shaderId && this->textureId == other.textureId && this->instanced == other.instanced && this->vertex == other.vertex && this->index == other.index;
             }
             std::string Batch::Config::toString() const {
                 std::stringstream ss;
                 ss << "Config(" << vertex << ',' << index << ',';
-                ss << shaderId << ',' << textureId << ',' << preRender << ')';
+                ss << shaderId << ',' << textureId << ',' << preRender << ',' << instanced << ')';
                 return ss.str();
             }
 
-            Batch::Batch(size_t size, const Batch::Config& config)
-                : m_id(uuid<Batch>()), m_config(config) {
+            size_t Batch::Config::Hash::operator()(const Batch::Config& config) const {
+                size_t seed = 0;
+                auto combine = [&seed](size_t value) {
+                    seed ^= std::hash<size_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                };
+                combine(config.vertex.count);
+                combine(config.vertex.size);
+                combine(config.vertex.layout);
+                combine(config.index.count);
+                combine(config.index.size);
+                combine(config.index.primitiveCount);
+                combine(config.shaderId);
+                combine(config.textureId);
+                combine(config.instanced);
+                return seed;
+            }
+
+            Batch::Batch(size_t size, const Batch::Config& config, bool growable)
+                : m_id(uuid<Batch>()), m_size(size), m_growable(growable), m_config(config) {
                 auto layout = Storage<VertexLayout>::global()->get(m_config.vertex.layout);
                 if (!layout) {
                     throw exceptions::InvalidInput("could not find vertex layout with provided id");
                 }
-                m_vertexBuffer = Storage<VertexBuffer>::global()->create(config.vertex.size, config.vertex.count * size);
-                m_vertexArray = Storage<VertexArray>::global()->create(m_vertexBuffer, layout);
-                m_indexBuffer = Storage<IndexBuffer>::global()->create(config.index.primitiveCount, config.index.size, config.index.count * size);
+                if (m_config.instanced) {
+                    // removed instances are cleared so the shader can skip them
+                    m_vertexBuffer = Storage<VertexBuffer>::global()->create(config.vertex.size, config.vertex.count * size, true, true);
+                    m_vertexArray = Storage<VertexArray>::global()->create(m_vertexBuffer, layout, 1);
+                    m_indexBuffer = Storage<IndexBuffer>::global()->create(config.index.primitiveCount, config.index.size, config.index.count);
+                } else {
+                    m_vertexBuffer = Storage<VertexBuffer>::global()->create(config.vertex.size, config.vertex.count * size, true);
+                    m_vertexArray = Storage<VertexArray>::global()->create(m_vertexBuffer, layout);
+                    m_indexBuffer = Storage<IndexBuffer>::global()->create(config.index.primitiveCount, config.index.size, config.index.count * size, true);
+                }
                 TME_INFO("created {}", *this);
             }
 
+            Batch& Batch::operator=(Batch&& other) {
+                if (this != &other) {
+                    release();
+                    m_id = other.m_id;
+                    m_size = other.m_size;
+                    m_growable = other.m_growable;
+                    m_vertexBuffer = std::move(other.m_vertexBuffer);
+                    m_vertexArray = std::move(other.m_vertexArray);
+                    m_indexBuffer = std::move(other.m_indexBuffer);
+                    m_config = other.m_config;
+                    m_usedSpaces = std::move(other.m_usedSpaces);
+                    m_drawCounts = std::move(other.m_drawCounts);
+                    m_drawOffsets = std::move(other.m_drawOffsets);
+                }
+                return *this;
+            }
+
             Batch::~Batch() {
+                release();
+            }
+
+            void Batch::release() {
+                // the buffers of a moved from batch belong to another one
+                if (!m_vertexArray) {
+                    return;
+                }
                 TME_INFO("deleting {}", *this);
                 Storage<VertexBuffer>::global()->destroy(m_vertexArray->getVertexBuffer()->getId());
                 Storage<VertexArray>::global()->destroy(m_vertexArray->getId());
                 Storage<IndexBuffer>::global()->destroy(m_indexBuffer->getId());
+                m_vertexBuffer = nullptr;
+                m_vertexArray = nullptr;
+                m_indexBuffer = nullptr;
             }
 
-            Batch::Entry Batch::add(Handle<Batchable> object) {
-                TME_ASSERT(object->getBatchConfig() == m_config, "trying to add unsuitable data to batch");
-                Buffer::Space vertexSpace = m_vertexBuffer->add(static_cast<GLsizeiptr>(m_config.vertex.count), object->getVertexData());
-                // losing larger values is ok (if they exceed 32 bit something is really off in the data definition)
-                object->setIndexOffset((unsigned int)vertexSpace.offset);
-                Buffer::Space indexSpace = m_indexBuffer->add(static_cast<GLsizeiptr>(m_config.index.count), object->getIndexData());
+            Batch::Entry Batch::add(Batchable& object) {
+                TME_ASSERT(object.getBatchConfig() == m_config, "trying to add unsuitable data to batch");
+                if (m_growable) {
+                    auto vertexCount = static_cast<GLsizeiptr>(m_config.vertex.count);
+                    auto indexCount = static_cast<GLsizeiptr>(m_config.index.count);
+                    bool indicesFit = m_config.instanced || m_indexBuffer->getLargestFreeSpace() >= indexCount;
+                    if (m_vertexBuffer->getLargestFreeSpace() < vertexCount || !indicesFit) {
+                        resize(m_size > 0 ? m_size * 2 : 1);
+                    }
+                }
+                Buffer::Space vertexSpace = m_vertexBuffer->add(static_cast<GLsizeiptr>(m_config.vertex.count), object.getVertexData());
+                Buffer::Space indexSpace;
+                if (m_config.instanced) {
+                    indexSpace = {0, static_cast<GLsizeiptr>(m_config.index.count)};
+                    if (m_indexBuffer->getUsedSize() == 0) {
+                        object.setIndexOffset(0);
+                        indexSpace = m_indexBuffer->add(indexSpace.size, object.getIndexData());
+                    }
+                } else {
+                    // losing larger values is ok (if they exceed 32 bit something is really off in the data definition)
+                    object.setIndexOffset((unsigned int)vertexSpace.offset);
+                    indexSpace = m_indexBuffer->add(static_cast<GLsizeiptr>(m_config.index.count), object.getIndexData());
+                }
                 Batch::Entry e;
                 e.batchId = getId();
                 e.vertexSpace = vertexSpace;
@@ -86,22 +160,75 @@ namespace tme {
                 return e;
             }
 
-            void Batch::update(const Entry& entry, Handle<Batchable> object) {
-                TME_ASSERT(object->getBatchConfig() == m_config, "trying to add unsuitable data to batch");
-                m_vertexBuffer->update(entry.vertexSpace, object->getVertexData());
-                m_indexBuffer->update(entry.indexSpace, object->getIndexData());
+            void Batch::update(const Entry& entry, const Batchable& object) {
+                TME_ASSERT(object.getBatchConfig() == m_config, "trying to add unsuitable data to batch");
+                m_vertexBuffer->update(entry.vertexSpace, object.getVertexData());
+                if (!m_config.instanced) {
+                    m_indexBuffer->update(entry.indexSpace, object.getIndexData());
+                }
             }
 
             void Batch::remove(const Entry& entry) {
                 m_vertexBuffer->remove(entry.vertexSpace);
-                m_indexBuffer->remove(entry.indexSpace);
+                if (!m_config.instanced) {
+                    m_indexBuffer->remove(entry.indexSpace);
+                }
+            }
+
+            void Batch::resize(size_t size) {
+                if (size <= m_size) {
+                    return;
+                }
+                m_vertexBuffer->resize(static_cast<GLsizeiptr>(m_config.vertex.count * size));
+                if (!m_config.instanced) {
+                    m_indexBuffer->resize(static_cast<GLsizeiptr>(m_config.index.count * size));
+                }
+                m_size = size;
+                TME_INFO("resized {}", *this);
             }
 
             void Batch::render() {
+                m_config.preRender(m_config.shaderId, m_config.textureId);
+                draw();
+            }
+
+            void Batch::draw() {
+                Profiler::Scope scope("Batch", m_id);
+                m_vertexBuffer->flush();
+                m_indexBuffer->flush();
                 m_vertexArray->bind();
                 m_indexBuffer->bind();
-                m_config.preRender(m_config.shaderId, m_config.textureId);
-                glCall(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_indexBuffer->getPrimitiveCount()), GL_UNSIGNED_INT, nullptr));
+                if (m_config.instanced) {
+                    glCall(glDrawElementsInstanced(GL_TRIANGLES, m_indexBuffer->getUsedPrimitiveCount(), GL_UNSIGNED_INT, nullptr, getInstanceCount()));
+                    State::global().countDraw(static_cast<size_t>(m_indexBuffer->getUsedPrimitiveCount() / 3) * static_cast<size_t>(getInstanceCount()));
+                    return;
+                }
+                // removed objects leave cleared indices behind, only the ranges between them are drawn
+                m_indexBuffer->getUsedSpaces(m_usedSpaces);
+                m_drawCounts.clear();
+                m_drawOffsets.clear();
+                size_t indexCount = 0;
+                for (const auto& space : m_usedSpaces) {
+                    m_drawCounts.push_back(static_cast<GLsizei>(space.size * static_cast<GLsizeiptr>(m_config.index.primitiveCount)));
+                    m_drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(space.offset) * m_config.index.size));
+                    indexCount += static_cast<size_t>(m_drawCounts.back());
+                }
+                if (m_drawCounts.empty()) {
+                    return;
+                }
+                if (m_drawCounts.size() == 1) {
+                    glCall(glDrawElements(GL_TRIANGLES, m_drawCounts.front(), GL_UNSIGNED_INT, m_drawOffsets.front()));
+                } else {
+                    glCall(glMultiDrawElements(GL_TRIANGLES, m_drawCounts.data(), GL_UNSIGNED_INT, m_drawOffsets.data(), static_cast<GLsizei>(m_drawCounts.size())));
+                }
+                State::global().countDraw(indexCount / 3);
+            }
+
+            GLsizei Batch::getInstanceCount() const {
+                if (!m_config.instanced || m_config.vertex.count == 0) {
+                    return 0;
+                }
+                return static_cast<GLsizei>(m_vertexBuffer->getUsedSize() / static_cast<GLsizeiptr>(m_config.vertex.count));
             }
 
             std::string Batch::toString() const {
@@ -113,83 +240,132 @@ namespace tme {
                 return ss.str();
             }
 
-            Batcher::Batcher(size_t batchSize) : m_mappings(), m_batches(Storage<Batch>::localInstance()), m_batchSize(batchSize) {
+            BatchPool::BatchPool(size_t batchSize) : m_configBatches(), m_batches(), m_batchSize(batchSize) {
+                TME_INFO("created {}", *this);
+            }
+
+            BatchPool::~BatchPool() {
+                TME_INFO("deleting {}", *this);
+                m_configBatches.clear();
+                m_batches.clear();
+            }
+
+            Batch& BatchPool::get(const Batch::Config& config) {
+                return *m_batches.get(getKey(config));
+            }
+
+            BatchPool::Key BatchPool::getKey(const Batch::Config& config) {
+                if (const auto& iter = m_configBatches.find(config); iter != m_configBatches.end()) {
+                    if (m_batches.has(iter->second)) {
+                        return iter->second;
+                    }
+                }
+                Key key = m_batches.emplace(m_batchSize, config, true);
+                m_configBatches.insert_or_assign(config, key);
+                return key;
+            }
+
+            void BatchPool::render() {
+                for (auto& batch : m_batches) {
+                    batch.render();
+                }
+            }
+
+            void BatchPool::submit(RenderQueue& queue, uint16_t layer) {
+                for (size_t i = 0; i < m_batches.size(); ++i) {
+                    queue.submit(layer, *this, m_batches.getKey(i));
+                }
+            }
+
+            std::string BatchPool::toString() const {
+                std::stringstream ss;
+                ss << "BatchPool(";
+                for (const auto& batch : m_batches) {
+                    ss << batch;
+                }
+                ss << ')';
+                return ss.str();
+            }
+
+            Batcher::Batcher(size_t batchSize) : m_mappings(), m_pool(new BatchPool(batchSize)) {
+                TME_INFO("created {}", *this);
+            }
+
+            Batcher::Batcher(Handle<BatchPool> pool) : m_mappings(), m_pool(pool) {
                 TME_INFO("created {}", *this);
             }
 
             Batcher::~Batcher() {
                 TME_INFO("deleting {}", *this);
+                // the batches of an owned pool are deleted with it, a shared pool has to drop the objects of this batcher
+                if (m_pool.use_count() > 1) {
+                    for (const auto& iter : m_mappings) {
+                        if (auto batch = m_pool->find(iter.second.batch)) {
+                            batch->remove(iter.second.entry);
+                        }
+                    }
+                }
                 m_mappings.clear();
-                m_batches->clear();
             }
 
-            void Batcher::set(Handle<Batchable> object) {
+            void Batcher::set(Batchable& object) {
+                const Batch::Config config = object.getBatchConfig();
                 // check existing mappings
-                if (const auto& iter = m_mappings.find(object->getId()); iter != m_mappings.end()) {
-                    if (m_batches->has(iter->second.batchId)) {
-                        auto previousBatch = m_batches->get(iter->second.batchId);
-                        if (previousBatch->getConfig() == object->getBatchConfig()) {
+                if (const auto& iter = m_mappings.find(object.getId()); iter != m_mappings.end()) {
+                    if (auto previousBatch = m_pool->find(iter->second.batch)) {
+                        if (previousBatch->getConfig() == config) {
                             // batch did not change so only an update is required
-                            previousBatch->update(iter->second, object);
+                            previousBatch->update(iter->second.entry, object);
                             return;
                         } else {
                             // another batch is needed to store object, so remove from old batch
-                            previousBatch->remove(iter->second);
+                            previousBatch->remove(iter->second.entry);
                         }
                     }
+                    // only mapped again once the object has been added to its new batch, so its old entry is never removed twice
+                    m_mappings.erase(iter);
                 }
-                // determine new batch
-                Handle<Batch> currentBatch;
-                for (const auto& iter : *m_batches) {
-                    // check if an existing batch satisfies the requested config
-                    if (iter.second->getConfig() == object->getBatchConfig()) {
-                        currentBatch = iter.second;
-                        break;
-                    }
-                }
-                // no known batch has requested config
-                if (!currentBatch) {
-                    try {
-                        // create new batch with requested config
-                        currentBatch = m_batches->create(m_batchSize, object->getBatchConfig());
-                    } catch(const exceptions::InvalidInput& e) {
-                        TME_ERROR("could not create new batch: {}, {}", e.type(), e.what());
-                        return;
-                    }
+                // determine new batch, creating one if no known batch has the requested config
+                BatchPool::Key currentKey;
+                Batch* currentBatch;
+                try {
+                    currentKey = m_pool->getKey(config);
+                    currentBatch = m_pool->find(currentKey);
+                } catch(const exceptions::InvalidInput& e) {
+                    TME_ERROR("could not create new batch: {}, {}", e.type(), e.what());
+                    return;
                 }
                 try {
                     // add data to new batch
                     Batch::Entry newEntry = currentBatch->add(object);
-                    m_mappings.insert_or_assign(object->getId(), newEntry);
+                    m_mappings.insert({object.getId(), Mapping{currentKey, newEntry}});
                 } catch (const exceptions::InsufficientBufferSpace& e) {
                     TME_ERROR("could not add data to batch: {}, {}", e.type(), e.what());
                 }
             }
 
-            void Batcher::unset(Handle<Batchable> object) {
-                if (const auto& iter = m_mappings.find(object->getId()); iter != m_mappings.end()) {
-                    if (m_batches->has(iter->second.batchId)) {
-                        auto batch = m_batches->get(iter->second.batchId);
-                        batch->remove(iter->second);
-                        m_mappings.erase(object->getId());
+            void Batcher::unset(const Batchable& object) {
+                if (const auto& iter = m_mappings.find(object.getId()); iter != m_mappings.end()) {
+                    if (auto batch = m_pool->find(iter->second.batch)) {
+                        batch->remove(iter->second.entry);
+                        m_mappings.erase(object.getId());
                     }
                 }
             }
 
             void Batcher::render() {
-                for (const auto& iter : *m_batches) {
-                    iter.second->render();
-                }
+                m_pool->render();
+            }
+
+            void Batcher::submit(RenderQueue& queue, uint16_t layer) const {
+                m_pool->submit(queue, layer);
             }
 
             std::string Batcher::toString() const {
                 std::stringstream ss;
-                ss << "Batcher(";
-                for (const auto& iter : *m_batches) {
-                    ss << *iter.second;
-                }
+                ss << "Batcher(" << *m_pool;
                 for (const auto& iter : m_mappings) {
-                    ss << "Map(" << iter.first << ',' << iter.second.batchId << ')';
+                    ss << "Map(" << iter.first << ',' << iter.second.entry.batchId << ')';
                 }
                 ss << ')';
                 return ss.str();
@@ -4,10 +4,12 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "core/graphics/common.hpp"
 #include "core/graphics/texture.hpp"
 #include "core/graphics/buffer.hpp"
 #include "core/storage.hpp"
+#include "core/slotmap.hpp"
 #include "core/graphics/vertex.hpp"
 #include "core/graphics/index.hpp"
 
@@ -16,6 +18,7 @@ namespace tme {
         namespace graphics {
 
             class Batchable;
+            class RenderQueue;
 
             /**//**
              * \brief Storage and rendering abstraction to group similar graphics objects.
@@ -24,6 +27,12 @@ namespace tme {
              * shader and texture to be grouped together to reduce the amount of render calls made
              * to the GPU.
              * It is created with a set amount of graphics objects it should be able to store.
+             * A growable Batch doubles its capacity when it is full instead of rejecting objects.
+             * Vertex and index data is streamed, so all changes between two render calls are uploaded together.
+             *
+             * An instanced Batch stores a single copy of the index data which is shared by all objects.
+             * The vertex data of an object is then used as per instance attributes and all objects are
+             * rendered with one instanced draw call.
              */
             class Batch final : public Loggable, public Mappable, public Renderable {
                 public:
@@ -31,7 +40,8 @@ namespace tme {
                  * \brief Configuration of a batch.
                  *
                  * Contains description of the data that will be contained inside.
-                 * Implements equality comparison operator for deep compare.
+                 * Implements equality comparison operator for deep compare and
+                 * Config::Hash to be usable as a key in unordered containers.
                  */
                 struct Config final: public Loggable {
                     /**//**
@@ -116,6 +126,8 @@ namespace tme {
                     Identifier textureId;
                     /// prerender hook to make custom shader and texture calls if necessary
                     void (*preRender)(Identifier, Identifier);
+                    /// true if the vertex data is per instance data and the index data is shared by all objects
+                    bool instanced;
 
                     /**//**
                      * \brief Construct Config instance defaulting the textureId to NO_TEXTURE.
@@ -129,13 +141,14 @@ namespace tme {
                      * @param preRenderHook function called before rendering the batch
                      * @param shader Identifier for a Shader in global Storage
                      * @param texture Identifier for a Texture in global Storage or NO_TEXTURE by default
+                     * @param instancedRendering true if objects should be rendered as instances of the same index data
                      */
-                    Config(const Vertex& vertexDefinition, const Index& indexDefinition, void (*preRenderHook)(Identifier, Identifier), Identifier shader, Identifier texture = NO_TEXTURE);
+                    Config(const Vertex& vertexDefinition, const Index& indexDefinition, void (*preRenderHook)(Identifier, Identifier), Identifier shader, Identifier texture = NO_TEXTURE, bool instancedRendering = false);
 
                     /**//**
                      * \brief Deep equality operator.
                      *
-                     * Compares itself with other by comparing vertex, index, shaderId and textureId.
+                     * Compares itself with other by comparing vertex, index, shaderId, textureId and instanced.
                      *
                      * @param other right hand side value to compare itself against
                      *
@@ -144,12 +157,30 @@ namespace tme {
                     bool operator ==(const Config& other) const;
 
                     std::string toString() const override;
+
+                    /**//**
+                     * \brief Hash function object for Config.
+                     *
+                     * Combines the members also used by the equality operator,
+                     * so equal configs produce equal hashes.
+                     */
+                    struct Hash {
+                        /**//**
+                         * \brief Calculate hash of config.
+                         *
+                         * @param config the Config to be hashed
+                         *
+                         * @return hash value of the config
+                         */
+                        size_t operator()(const Config& config) const;
+                    };
                 };
                 /**//**
                  * \brief Value object defining an graphics object inside the batch.
                  *
                  * Contains the id of the batch and its corresponding Batch::Space for
                  * vertex and index data respectively.
+                 * Inside an instanced Batch the index space is the one shared by all objects.
                  */
                 struct Entry {
                     /// id of the batch it is stored in
@@ -162,10 +193,16 @@ namespace tme {
 
                 private:
                 Identifier m_id;
+                size_t m_size;
+                bool m_growable;
                 Handle<VertexBuffer> m_vertexBuffer;
                 Handle<VertexArray> m_vertexArray;
                 Handle<IndexBuffer> m_indexBuffer;
                 Config m_config;
+                // command buffer of the last draw, one range of indices per run of objects between removed ones
+                std::vector<Buffer::Space> m_usedSpaces;
+                std::vector<GLsizei> m_drawCounts;
+                std::vector<const void*> m_drawOffsets;
 
                 public:
                 /**//**
@@ -176,49 +213,117 @@ namespace tme {
                  *
                  * @param size number of objects the batch should be able to hold
                  * @param config configuration of the batch
+                 * @param growable true if the batch should grow when it is full, false to throw instead
                  */
-                Batch(size_t size, const Config& config);
+                Batch(size_t size, const Config& config, bool growable = false);
+                /**//**
+                 * \brief Move the buffers of a batch into a new one.
+                 *
+                 * Allows a BatchPool to store its batches by value. The moved from batch does not own buffers anymore
+                 * and may only be deleted or assigned to.
+                 *
+                 * @param other batch to be moved
+                 */
+                Batch(Batch&& other) = default;
+                Batch& operator=(Batch&& other);
+                Batch(const Batch&) = delete;
+                Batch& operator=(const Batch&) = delete;
                 ~Batch();
 
                 /**//**
                  * \brief Adds batchable object to the batch.
                  *
                  * Uses the setIndexOffset of the Batchable object to be able to insert the
-                 * correct index data.
+                 * correct index data. An instanced Batch only stores the index data of the first object
+                 * with an offset of 0.
+                 * A growable Batch is resized to twice its size if the object does not fit.
                  *
                  * @param object the object to be added to the batch
                  *
-                 * @throw InsufficientBufferSpace when the Batch's buffer cannot store the requested data
+                 * @throw InsufficientBufferSpace when the Batch's buffer cannot store the requested data and it is not growable
                  *
                  * @return Entry instance describing the data inside the buffer to be used for updates or removal
                  */
-                Entry add(Handle<Batchable> object);
+                Entry add(Batchable& object);
                 /**//**
                  * \brief Updates batchable object at entry in the batch.
                  *
                  * @param entry Entry describing the location of the data in the buffers
                  * @param object the Batchable with the new data
                  */
-                void update(const Entry& entry, Handle<Batchable> object);
+                void update(const Entry& entry, const Batchable& object);
                 /**//**
                  * \brief Remove data from batch.
                  *
+                 * The shared index data of an instanced Batch is kept.
+                 *
                  * @param entry Entry describing the location of the data in the buffers
                  */
                 void remove(const Entry& entry);
+                /**//**
+                 * \brief Increase the number of objects the batch is able to hold.
+                 *
+                 * Existing data is kept in place, so all previously returned Entry instances stay valid.
+                 * Sizes smaller or equal to the current size are ignored.
+                 *
+                 * @param size the new number of objects the batch should be able to hold
+                 */
+                void resize(size_t size);
 
                 void render() override;
+                /**//**
+                 * \brief Render the batch without calling the preRender hook.
+                 *
+                 * Used if the shader and texture have already been set up by the hook of a batch with the same Config::preRender,
+                 * Config::shaderId and Config::textureId.
+                 * A batch which is not instanced skips the index ranges of removed objects, the remaining ranges
+                 * are drawn with a single glMultiDrawElements call.
+                 */
+                void draw();
 
                 Identifier getId() const override { return m_id; }
 
+                /**//**
+                 * \brief Get number of objects the batch is currently able to hold.
+                 *
+                 * @return size of the batch
+                 */
+                inline size_t getSize() const { return m_size; }
+
+                /**//**
+                 * \brief Get number of instances rendered by an instanced Batch.
+                 *
+                 * Removed objects in between are included and skipped by the shader.
+                 *
+                 * @return number of instances to be rendered, 0 if the batch is not instanced
+                 */
+                GLsizei getInstanceCount() const;
+
                 /**//**
                  * \brief Get the Batch's Config.
                  *
                  * @return configuration of the batch
                  */
-                inline Config getConfig() const { return m_config; }
+                inline const Config& getConfig() const { return m_config; }
+
+                /**//**
+                 * \brief Get the vertex array of the Batch.
+                 *
+                 * @return OpenGL name of the vertex array
+                 */
+                inline Identifier getVertexArrayId() const { return m_vertexArray->getId(); }
+
+                /**//**
+                 * \brief Get number of index ranges drawn by the last draw().
+                 *
+                 * @return number of commands of the last draw call, 0 if the batch is instanced or has not been drawn
+                 */
+                inline size_t getDrawCommandCount() const { return m_drawCounts.size(); }
 
                 std::string toString() const override;
+
+                private:
+                void release();
             };
 
             /**//**
@@ -264,24 +369,119 @@ namespace tme {
                 virtual const void* getIndexData() const = 0;
             };
 
+            /**//**
+             * \brief Growable batches which can be shared by several Batcher instances.
+             *
+             * Holds one Batch per Config, objects of the same Config share its buffers no matter which Batcher added them.
+             * Batchers splitting a scene into parts, like the chunks of a map, share a pool so each Config
+             * is drawn with one draw call instead of one per part.
+             */
+            class BatchPool final : public Loggable, public Renderable {
+                public:
+                /// dense storage of the batches by value, iterated every frame
+                using Batches = SlotMap<Batch>;
+                /// stable reference to a Batch of the pool
+                using Key = Batches::Key;
+
+                private:
+                // batch used for new objects of a config, batches grow so one per config is enough
+                std::unordered_map<Batch::Config, Key, Batch::Config::Hash> m_configBatches;
+                Batches m_batches;
+                size_t m_batchSize;
+
+                public:
+                /**//**
+                 * \brief Create empty pool.
+                 *
+                 * @param batchSize the amount of objects all batches should initially be able to store
+                 */
+                BatchPool(size_t batchSize);
+                ~BatchPool();
+
+                /**//**
+                 * \brief Get the Batch of a Config, creating it if needed.
+                 *
+                 * @param config configuration of the requested batch
+                 *
+                 * @throw InvalidInput when the batch cannot be created from the config
+                 *
+                 * @return reference to the growable Batch storing objects with config, valid until another batch is created
+                 */
+                Batch& get(const Batch::Config& config);
+                /**//**
+                 * \brief Get the Key of the Batch of a Config, creating the batch if needed.
+                 *
+                 * @param config configuration of the requested batch
+                 *
+                 * @throw InvalidInput when the batch cannot be created from the config
+                 *
+                 * @return Key of the growable Batch storing objects with config
+                 */
+                Key getKey(const Batch::Config& config);
+                /**//**
+                 * \brief Find a Batch of the pool.
+                 *
+                 * @param key Key of the batch
+                 *
+                 * @return pointer to the Batch, nullptr if the pool does not contain it anymore, valid until another batch is created
+                 */
+                inline Batch* find(Key key) { return m_batches.get(key); }
+
+                void render() override;
+                /**//**
+                 * \brief Add all batches to a RenderQueue instead of rendering them directly.
+                 *
+                 * The pool has to outlive the flush of the queue.
+                 *
+                 * @param queue the RenderQueue the batches are rendered by
+                 * @param layer position of the batches in the draw order, lower layers are drawn first
+                 */
+                void submit(RenderQueue& queue, uint16_t layer);
+
+                /**//**
+                 * \brief Get the batches of the pool.
+                 *
+                 * @return reference to the dense storage of the batches
+                 */
+                inline const Batches& getBatches() const { return m_batches; }
+                inline Batches& getBatches() { return m_batches; }
+
+                std::string toString() const override;
+            };
+
             /**//**
              * \brief Manager used to dynamically create needed Batch instances and add Batchable to them.
              *
              * Will create new batches when it does not have a suitable one for a Batchable object.
              * Otherwise the object will be added to an existing batch from which it can be removed as well.
+             * The created batches are growable so they only use as much memory as needed.
+             * The batches live in a BatchPool, which is either owned by the Batcher or shared with other Batchers.
              */
             class Batcher final : public Loggable, public Renderable {
-                std::unordered_map<Identifier, Batch::Entry> m_mappings;
-                Handle<Storage<Batch>> m_batches;
-                size_t m_batchSize;
+                // where an object is stored, the pool key avoids hashing the batch id on every update
+                struct Mapping {
+                    BatchPool::Key batch;
+                    Batch::Entry entry;
+                };
+
+                std::unordered_map<Identifier, Mapping> m_mappings;
+                Handle<BatchPool> m_pool;
 
                 public:
                 /**//**
-                 * \brief Create manager instance.
+                 * \brief Create manager instance with its own BatchPool.
                  *
-                 * @param batchSize the amount of objects all batches should be able to store
+                 * @param batchSize the amount of objects all batches should initially be able to store
                  */
                 Batcher(size_t batchSize);
+                /**//**
+                 * \brief Create manager instance adding its objects to a shared BatchPool.
+                 *
+                 * The objects are removed from the pool when the Batcher is deleted.
+                 *
+                 * @param pool Handle to the BatchPool shared with other Batchers
+                 */
+                Batcher(Handle<BatchPool> pool);
                 ~Batcher();
 
                 /**//**
@@ -291,9 +491,11 @@ namespace tme {
                  * If either a Batch cannot be created or a Batchable object cannot be added to an Batch
                  * an error is logged as this should be caught in debug builds indicating an application issue.
                  *
+                 * The data of the object is copied, so it does not have to outlive the call.
+                 *
                  * @param object the graphics object to be added
                  */
-                void set(Handle<Batchable> object);
+                void set(Batchable& object);
                 /**//**
                  * \brief Remove object.
                  *
@@ -301,16 +503,36 @@ namespace tme {
                  *
                  * @param object the graphics object to be removed
                  */
-                void unset(Handle<Batchable> object);
+                void unset(const Batchable& object);
 
+                /**//**
+                 * \brief Render all batches of the BatchPool.
+                 *
+                 * Objects of other Batchers sharing the pool are rendered as well.
+                 */
                 void render() override;
+                /**//**
+                 * \brief Add all batches of the BatchPool to a RenderQueue instead of rendering them directly.
+                 *
+                 * Objects of other Batchers sharing the pool are rendered as well.
+                 *
+                 * @param queue the RenderQueue the batches are rendered by
+                 * @param layer position of the batches in the draw order, lower layers are drawn first
+                 */
+                void submit(RenderQueue& queue, uint16_t layer) const;
 
                 /**//**
-                 * \brief Get Handle for local Batch Storage.
+                 * \brief Get the batches of the BatchPool.
+                 *
+                 * @return reference to the dense storage of the batches of the pool
+                 */
+                inline const BatchPool::Batches& getBatches() const { return m_pool->getBatches(); }
+                /**//**
+                 * \brief Get the BatchPool the objects are added to.
                  *
-                 * @return Handle to the local storage of the batches, should not be stored somewhere
+                 * @return Handle to the pool of the batches
                  */
-                inline Handle<Storage<Batch>> getBatches() const { return m_batches; }
+                inline Handle<BatchPool> getPool() const { return m_pool; }
 
                 std::string toString() const override;
             };
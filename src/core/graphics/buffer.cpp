@@ -1,41 +1,51 @@
 /** @file */
 #include "core/graphics/buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <sstream>
 #include "core/storage.hpp"
+#include "core/graphics/state.hpp"
 
 namespace tme {
     namespace  core {
         namespace graphics {
 
-            Buffer::Buffer(GLenum type, GLsizeiptr entrySize, GLsizeiptr size)
+            const unsigned char Buffer::s_zeroPage[Buffer::s_zeroPageSize] = {};
+
+            Buffer::Buffer(GLenum type, GLsizeiptr entrySize, GLsizeiptr size, bool streaming, bool clearOnRemove)
                 : m_type(type),
                 m_entrySize(entrySize),
                 m_size(size),
                 m_nextOffset(0),
-                m_freeSpaces() {
+                m_freeOffsets(),
+                m_freeSizes(),
+                m_freeSize(0),
+                m_clearOnRemove(clearOnRemove),
+                m_streaming(streaming),
+                m_dirtyRanges(),
+                m_spareRanges() {
                 glCall(glGenBuffers(1, &m_renderingId));
                 bind();
-                int64_t bufferSize = entrySize * size;
-                m_neutralBuffer = new unsigned char[(size_t)bufferSize];
-                for (int64_t i = 0; i < bufferSize ; ++i) {
-                    m_neutralBuffer[i] = 0;
-                }
-                glCall(glBufferData(type, bufferSize, m_neutralBuffer, GL_STATIC_DRAW));
+                allocate();
             }
             Buffer::~Buffer() {
-                delete[] m_neutralBuffer;
                 unbind();
                 glCall(glDeleteBuffers(1, &m_renderingId));
+                State::global().forgetBuffer(m_renderingId);
             }
 
             Buffer::Space Buffer::add(GLsizeiptr size, const void* data) {
-                for (auto iter = m_freeSpaces.begin(); iter != m_freeSpaces.end(); ++iter) {
-                    if (iter->size == size) {
-                        Space dataSpace{ iter->offset, size };
-                        update(dataSpace, data);
-                        m_freeSpaces.erase(iter);
-                        return dataSpace;
+                // smallest free space able to hold the data, offset 0 sorts before all spaces of equal size
+                if (auto fit = m_freeSizes.lower_bound({ 0, size }); fit != m_freeSizes.end()) {
+                    Space freeSpace = *fit;
+                    eraseFreeSpace(freeSpace);
+                    if (freeSpace.size > size) {
+                        insertFreeSpace({ freeSpace.offset + size, freeSpace.size - size });
                     }
+                    Space dataSpace{ freeSpace.offset, size };
+                    update(dataSpace, data);
+                    return dataSpace;
                 }
                 // subtracting here avoids overflow
                 if (m_size - size >= m_nextOffset) {
@@ -48,30 +58,224 @@ namespace tme {
             }
 
             void Buffer::update(const Buffer::Space& space, const void* data) {
+                if (m_streaming) {
+                    stage(space, data);
+                    return;
+                }
                 bind();
                 glCall(glBufferSubData(m_type, space.offset * m_entrySize, space.size * m_entrySize, data));
+                State::global().countUpload(space.size * m_entrySize);
+            }
+
+            GLsizeiptr Buffer::getEntryCount(const std::vector<unsigned char>& bytes) const {
+                return static_cast<GLsizeiptr>(bytes.size()) / m_entrySize;
+            }
+
+            void Buffer::stage(const Buffer::Space& space, const void* data) {
+                GLsizeiptr first = space.offset;
+                GLsizeiptr last = space.offset + space.size;
+                // find all ranges overlapping or touching the space
+                auto begin = m_dirtyRanges.upper_bound(first);
+                if (begin != m_dirtyRanges.begin()) {
+                    if (auto prev = std::prev(begin); prev->first + getEntryCount(prev->second) >= first) {
+                        begin = prev;
+                    }
+                }
+                GLsizeiptr mergedFirst = first;
+                GLsizeiptr mergedLast = last;
+                auto end = begin;
+                for (; end != m_dirtyRanges.end() && end->first <= last; ++end) {
+                    mergedFirst = std::min(mergedFirst, end->first);
+                    mergedLast = std::max(mergedLast, end->first + getEntryCount(end->second));
+                }
+
+                Ranges::node_type range;
+                size_t byteCount = static_cast<size_t>((mergedLast - mergedFirst) * m_entrySize);
+                if (begin != end) {
+                    // the first range is extended in place, usually the space is appended to it
+                    auto next = std::next(begin);
+                    range = m_dirtyRanges.extract(begin);
+                    auto& bytes = range.mapped();
+                    if (range.key() > mergedFirst) {
+                        bytes.insert(bytes.begin(), static_cast<size_t>((range.key() - mergedFirst) * m_entrySize), 0);
+                    }
+                    bytes.resize(byteCount);
+                    while (next != end) {
+                        auto merged = next++;
+                        std::copy(merged->second.begin(), merged->second.end(), bytes.begin() + (merged->first - mergedFirst) * m_entrySize);
+                        m_spareRanges.push_back(m_dirtyRanges.extract(merged));
+                    }
+                } else if (!m_spareRanges.empty()) {
+                    range = std::move(m_spareRanges.back());
+                    m_spareRanges.pop_back();
+                    range.mapped().resize(byteCount);
+                }
+                if (!range) {
+                    // nothing to reuse yet, the new range is taken out to be filled like a reused one
+                    range = m_dirtyRanges.extract(m_dirtyRanges.emplace(mergedFirst, std::vector<unsigned char>(byteCount)).first);
+                }
+                range.key() = mergedFirst;
+                unsigned char* target = range.mapped().data() + (first - mergedFirst) * m_entrySize;
+                if (data) {
+                    std::memcpy(target, data, static_cast<size_t>(space.size * m_entrySize));
+                } else {
+                    std::memset(target, 0, static_cast<size_t>(space.size * m_entrySize));
+                }
+                m_dirtyRanges.insert(std::move(range));
+            }
+
+            void Buffer::flush() {
+                if (!m_streaming || m_dirtyRanges.empty()) {
+                    return;
+                }
+                State::global().bindBuffer(GL_COPY_WRITE_BUFFER, m_renderingId);
+                GLsizeiptr first = m_dirtyRanges.begin()->first;
+                GLsizeiptr last = m_dirtyRanges.rbegin()->first + getEntryCount(m_dirtyRanges.rbegin()->second);
+                if (m_dirtyRanges.size() == 1 && first == 0 && last >= m_nextOffset) {
+                    // everything in use changed, orphan the old storage to avoid waiting for pending draws
+                    glCall(glBufferData(GL_COPY_WRITE_BUFFER, m_size * m_entrySize, nullptr, GL_DYNAMIC_DRAW));
+                }
+                void* mapped = nullptr;
+                if (m_dirtyRanges.size() > s_maxDirtyRanges) {
+                    // one mapping of the span is cheaper than many small uploads, clean entries in between are kept
+                    glCall(mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, first * m_entrySize, (last - first) * m_entrySize,
+                                GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+                }
+                for (const auto& range : m_dirtyRanges) {
+                    GLsizeiptr size = static_cast<GLsizeiptr>(range.second.size());
+                    if (mapped) {
+                        GLsizeiptr offset = (range.first - first) * m_entrySize;
+                        std::memcpy(static_cast<unsigned char*>(mapped) + offset, range.second.data(), range.second.size());
+                        glCall(glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, offset, size));
+                    } else {
+                        glCall(glBufferSubData(GL_COPY_WRITE_BUFFER, range.first * m_entrySize, size, range.second.data()));
+                    }
+                    State::global().countUpload(size);
+                }
+                if (mapped) {
+                    glCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+                }
+                while (!m_dirtyRanges.empty()) {
+                    m_spareRanges.push_back(m_dirtyRanges.extract(m_dirtyRanges.begin()));
+                }
             }
 
             void Buffer::remove(const Buffer::Space& space) {
-                if (space.offset != INVALID_OFFSET) {
-                    update(space, m_neutralBuffer);
-                    m_freeSpaces.push_back(space);
+                if (space.offset == INVALID_OFFSET) {
+                    return;
+                }
+                if (m_clearOnRemove) {
+                    clear(space);
+                }
+                Space merged = space;
+                auto next = m_freeOffsets.lower_bound(space.offset);
+                TME_ASSERT(next == m_freeOffsets.end() || next->first >= space.offset + space.size, "releasing space which is already free");
+                if (next != m_freeOffsets.begin()) {
+                    if (auto prev = std::prev(next); prev->first + prev->second == merged.offset) {
+                        merged = { prev->first, prev->second + merged.size };
+                        eraseFreeSpace({ prev->first, prev->second });
+                    }
+                }
+                if (next != m_freeOffsets.end() && merged.offset + merged.size == next->first) {
+                    merged.size += next->second;
+                    eraseFreeSpace({ next->first, next->second });
+                }
+                if (merged.offset + merged.size == m_nextOffset) {
+                    // give space at the end back to the unused remainder of the buffer
+                    m_nextOffset = merged.offset;
+                } else {
+                    insertFreeSpace(merged);
+                }
+            }
+
+            void Buffer::resize(GLsizeiptr size) {
+                if (size <= m_size) {
+                    return;
+                }
+                // only the part up to the next offset can contain data, pending updates of streaming buffers stay staged
+                GLsizeiptr usedBytes = m_nextOffset * m_entrySize;
+                GLuint copyId = 0;
+                if (usedBytes > 0) {
+                    glCall(glGenBuffers(1, &copyId));
+                    State::global().bindBuffer(GL_COPY_WRITE_BUFFER, copyId);
+                    glCall(glBufferData(GL_COPY_WRITE_BUFFER, usedBytes, nullptr, GL_STREAM_COPY));
+                    State::global().bindBuffer(GL_COPY_READ_BUFFER, m_renderingId);
+                    glCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes));
+                }
+                m_size = size;
+                allocate();
+                if (copyId != 0) {
+                    State::global().bindBuffer(GL_COPY_READ_BUFFER, copyId);
+                    State::global().bindBuffer(GL_COPY_WRITE_BUFFER, m_renderingId);
+                    glCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes));
+                    glCall(glDeleteBuffers(1, &copyId));
+                    State::global().forgetBuffer(copyId);
+                }
+                TME_INFO("resized {}", *this);
+            }
+
+            void Buffer::allocate() {
+                GLsizeiptr bufferSize = m_entrySize * m_size;
+                GLenum usage = m_streaming ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+                // contents are left uninitialized, only the used part of the buffer is ever written and read
+                // the copy target avoids changing the element array binding of the currently bound vertex array
+                State::global().bindBuffer(GL_COPY_WRITE_BUFFER, m_renderingId);
+                glCall(glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, usage));
+            }
+
+            void Buffer::clear(const Buffer::Space& space) {
+                if (m_streaming) {
+                    stage(space, nullptr);
+                    return;
+                }
+                State::global().bindBuffer(GL_COPY_WRITE_BUFFER, m_renderingId);
+                GLsizeiptr offset = space.offset * m_entrySize;
+                GLsizeiptr end = offset + space.size * m_entrySize;
+                for (; offset < end; offset += s_zeroPageSize) {
+                    glCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, std::min(s_zeroPageSize, end - offset), s_zeroPage));
                 }
+                State::global().countUpload(space.size * m_entrySize);
+            }
+
+            void Buffer::insertFreeSpace(const Buffer::Space& space) {
+                m_freeOffsets.insert({ space.offset, space.size });
+                m_freeSizes.insert(space);
+                m_freeSize += space.size;
+            }
+
+            void Buffer::eraseFreeSpace(const Buffer::Space& space) {
+                m_freeOffsets.erase(space.offset);
+                m_freeSizes.erase(space);
+                m_freeSize -= space.size;
             }
             
             void Buffer::bind() const {
-                glCall(glBindBuffer(m_type, m_renderingId));
+                State::global().bindBuffer(m_type, m_renderingId);
             }
             void Buffer::unbind() const {
-                glCall(glBindBuffer(m_type, 0));
+                State::global().bindBuffer(m_type, 0);
+            }
+
+            GLsizeiptr Buffer::getLargestFreeSpace() const {
+                GLsizeiptr largest = m_size - m_nextOffset;
+                if (!m_freeSizes.empty() && m_freeSizes.rbegin()->size > largest) {
+                    largest = m_freeSizes.rbegin()->size;
+                }
+                return largest;
             }
 
-            GLsizeiptr Buffer::getFreeSpace() const {
-                GLsizeiptr freeSpace = m_size - m_nextOffset;
-                for (const auto& entry : m_freeSpaces) {
-                    freeSpace += entry.size;
+            void Buffer::getUsedSpaces(std::vector<Space>& spaces) const {
+                spaces.clear();
+                GLsizeiptr offset = 0;
+                for (const auto& free : m_freeOffsets) {
+                    if (free.first > offset) {
+                        spaces.push_back({ offset, free.first - offset });
+                    }
+                    offset = free.first + free.second;
+                }
+                if (m_nextOffset > offset) {
+                    spaces.push_back({ offset, m_nextOffset - offset });
                 }
-                return freeSpace;
             }
 
             std::string Buffer::toString() const {
@@ -2,6 +2,8 @@
 #define _CORE_GRAPHICS_BUFFER_H
 /** @file */
 
+#include <map>
+#include <set>
 #include <vector>
 #include "core/graphics/common.hpp"
 #include "core/loggable.hpp"
@@ -18,8 +20,18 @@ namespace tme {
              * \brief Abstraction of an OpenGL buffer.
              *
              * Provides infrastructure to create/delete an OpenGL buffer
-             * and add/remove data. The removal of data means overwriting it with zeros and
-             * allows to overwrite it in future additions.
+             * and add/remove data. The removal of data means overwriting it with zeros, unless disabled,
+             * and allows to overwrite it in future additions. Only the part up to getUsedSize() is initialized.
+             *
+             * Released spaces are kept in an address ordered free list in which neighbouring
+             * spaces are merged. A second index ordered by size allows to find the best fitting
+             * space for an addition in logarithmic time. Larger spaces are split on addition.
+             *
+             * A streaming Buffer stages updates in host memory until flush(). Only the changed ranges are kept,
+             * neighbouring ones are merged, so the host memory depends on the pending updates and not on the size
+             * of the buffer. flush() uploads them at once, many ranges are written through one mapping,
+             * so the number of OpenGL calls does not depend on the number of updates.
+             * The staging memory of uploaded ranges is reused by later updates.
              *
              * A Buffer is designed to store entries with a set size.
              * Because of that semantically the size and offset should be interpreted as entries
@@ -40,13 +52,36 @@ namespace tme {
                 };
 
                 private:
+                // orders spaces by size first to allow best fit lookups, offset makes entries unique
+                struct SizeOrder {
+                    bool operator()(const Space& lhs, const Space& rhs) const {
+                        return lhs.size < rhs.size || (lhs.size == rhs.size && lhs.offset < rhs.offset);
+                    }
+                };
+
+                // above this amount of separate dirty ranges they are uploaded in one call
+                static constexpr size_t s_maxDirtyRanges = 16;
+                // zeros shared by all buffers to clear removed spaces in chunks
+                static constexpr GLsizeiptr s_zeroPageSize = 4096;
+                static const unsigned char s_zeroPage[s_zeroPageSize];
+
                 GLenum m_type;
                 GLsizeiptr m_entrySize;
                 GLsizeiptr m_size;
                 GLsizeiptr m_nextOffset;
-                std::vector<Space> m_freeSpaces;
-                // buffer filled with zeros to reset buffer contents to avoid undeterministic random memory
-                unsigned char* m_neutralBuffer;
+                // free spaces mapped from offset to size, used to merge neighbouring spaces
+                std::map<GLsizeiptr, GLsizeiptr> m_freeOffsets;
+                // the same free spaces ordered by size, used to find the best fit
+                std::set<Space, SizeOrder> m_freeSizes;
+                // total size of all free spaces before m_nextOffset
+                GLsizeiptr m_freeSize;
+                bool m_clearOnRemove;
+                bool m_streaming;
+                using Ranges = std::map<GLsizeiptr, std::vector<unsigned char>>;
+                // data not yet uploaded in streaming mode mapped from the first entry of a contiguous range
+                Ranges m_dirtyRanges;
+                // uploaded ranges kept with their storage, so staging does not allocate once the buffer is in use
+                std::vector<Ranges::node_type> m_spareRanges;
 
                 public:
                 /**//**
@@ -55,15 +90,18 @@ namespace tme {
                  * @param type OpenGL enum value for buffer type
                  * @param entrySize size in bytes of the individual entries
                  * @param size the amount of entries the buffer should have space for
+                 * @param streaming true if updates should be collected and uploaded with flush(), false to upload them immediately
+                 * @param clearOnRemove true if removed spaces should be overwritten with zeros, false to leave the contents as is
                  */
-                Buffer(GLenum type, GLsizeiptr entrySize, GLsizeiptr size);
+                Buffer(GLenum type, GLsizeiptr entrySize, GLsizeiptr size, bool streaming = false, bool clearOnRemove = true);
                 virtual ~Buffer();
 
                 /**//**
                  * \brief Try to add size amount of data somewhere into the buffer.
                  *
-                 * Attempts to find space for the data. If not enough space is left inside the buffer
-                 * the returned Space will contain an INVALID_OFFSET.
+                 * Attempts to find space for the data. Previously released spaces are preferred,
+                 * choosing the smallest one which is able to hold the data.
+                 * If not enough space is left inside the buffer the returned Space will contain an INVALID_OFFSET.
                  *
                  * @param size amount of entries to be added to the buffer
                  * @param data pointer to entries
@@ -76,6 +114,7 @@ namespace tme {
                  * \brief Update existing data inside the buffer.
                  *
                  * Extracts necessary offset and size from space and writes data.
+                 * In streaming mode the data is uploaded with the next flush().
                  *
                  * @param space offset and size information
                  * @param data pointer to data used to overwrite data in space
@@ -84,11 +123,30 @@ namespace tme {
                 /**//**
                  * \brief Release space inside the buffer to be overwritten.
                  *
-                 * It overwrites the affected part of the buffer with zeros.
+                 * It overwrites the affected part of the buffer with zeros if the buffer clears on removal.
+                 * In streaming mode this happens with the next flush().
+                 * The space is merged with neighbouring free spaces.
                  *
                  * @param space the space to be released
                  */
                 void remove(const Space& space);
+                /**//**
+                 * \brief Increase the number of entries the buffer is able to hold.
+                 *
+                 * The contents are preserved by copying them on the GPU, so all previously returned
+                 * Space instances stay valid. The rendering id does not change.
+                 * Sizes smaller or equal to the current size are ignored.
+                 *
+                 * @param size the new amount of entries the buffer should have space for
+                 */
+                void resize(GLsizeiptr size);
+                /**//**
+                 * \brief Upload all pending updates of a streaming buffer.
+                 *
+                 * Should be called once before the buffer is used for rendering.
+                 * Does nothing if the buffer is not streaming or has no pending updates.
+                 */
+                void flush();
                 
                 void bind() const override;
                 void unbind() const override;
@@ -99,14 +157,58 @@ namespace tme {
                  * @return size of the buffer
                  */
                 inline GLsizeiptr getSize() const { return m_size; }
+                /**//**
+                 * \brief Get number of entries up to the end of the last used entry.
+                 *
+                 * Free spaces before the last used entry are included.
+                 *
+                 * @return size of the used part of the buffer
+                 */
+                inline GLsizeiptr getUsedSize() const { return m_nextOffset; }
+                /**//**
+                 * \brief Check if the buffer collects updates until flush() is called.
+                 *
+                 * @return true if the buffer is in streaming mode, false otherwise
+                 */
+                inline bool isStreaming() const { return m_streaming; }
                 /**//**
                  * \brief Get number of entries still available inside the buffer.
                  *
                  * @return free space inside the buffer
                  */
-                GLsizeiptr getFreeSpace() const;
+                inline GLsizeiptr getFreeSpace() const { return m_size - m_nextOffset + m_freeSize; }
+                /**//**
+                 * \brief Get number of entries of the largest contiguous free space.
+                 *
+                 * Additions larger than this will fail even if getFreeSpace() reports enough entries.
+                 *
+                 * @return size of the largest space that can currently be added
+                 */
+                GLsizeiptr getLargestFreeSpace() const;
+                /**//**
+                 * \brief Get number of separate free spaces inside the used part of the buffer.
+                 *
+                 * The unused remainder at the end of the buffer is not included.
+                 *
+                 * @return number of free spaces, 0 if the buffer is not fragmented
+                 */
+                inline size_t getFreeSpaceCount() const { return m_freeOffsets.size(); }
+                /**//**
+                 * \brief Get the used parts of the buffer between the free spaces.
+                 *
+                 * @param spaces receives the used spaces ordered by offset, previous contents are replaced
+                 */
+                void getUsedSpaces(std::vector<Space>& spaces) const;
 
                 virtual std::string toString() const override;
+
+                private:
+                void allocate();
+                void clear(const Space& space);
+                void stage(const Space& space, const void* data);
+                GLsizeiptr getEntryCount(const std::vector<unsigned char>& bytes) const;
+                void insertFreeSpace(const Space& space);
+                void eraseFreeSpace(const Space& space);
             };
 
         }
@@ -0,0 +1,352 @@
+/** @file */
+#include "core/graphics/cache.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include "stb/stb_image.h"
+#include "core/log.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            static_assert(sizeof(TextureCache::EntryHeader) == 24, "unexpected padding in TextureCache::EntryHeader");
+
+            namespace {
+
+                constexpr char s_magic[4] = {'T', 'M', 'E', 'C'};
+
+                // configuration of the global cache, the default directory is used if none has been configured
+                std::optional<std::string> s_globalDirectory;
+                uint64_t s_globalMaxBytes = TextureCache::DEFAULT_MAX_BYTES;
+                std::atomic<bool> s_globalCreated(false);
+
+                struct StoredEntry {
+                    std::string path;
+                    uint64_t size;
+                    time_t lastUse;
+                };
+
+                // entries in the directory, temporary files of stores in progress are skipped
+                std::vector<StoredEntry> listEntries(const std::string& directory) {
+                    std::vector<StoredEntry> entries;
+                    DIR* dir = opendir(directory.c_str());
+                    if (!dir) {
+                        return entries;
+                    }
+                    const std::string extension = ".rgba";
+                    while (const dirent* file = readdir(dir)) {
+                        std::string name = file->d_name;
+                        if (name.size() <= extension.size() || name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+                            continue;
+                        }
+                        std::string path = directory + '/' + name;
+                        struct stat status;
+                        if (stat(path.c_str(), &status) == 0) {
+                            entries.push_back({path, static_cast<uint64_t>(status.st_size), status.st_mtime});
+                        }
+                    }
+                    closedir(dir);
+                    return entries;
+                }
+
+                // read only mapping of a whole file, released on destruction
+                struct FileMapping {
+                    void* data = nullptr;
+                    size_t size = 0;
+
+                    explicit FileMapping(const std::string& filePath) {
+                        int fd = open(filePath.c_str(), O_RDONLY);
+                        if (fd < 0) {
+                            return;
+                        }
+                        struct stat status;
+                        if (fstat(fd, &status) == 0 && status.st_size > 0) {
+                            size = static_cast<size_t>(status.st_size);
+                            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                            if (data == MAP_FAILED) {
+                                data = nullptr;
+                            }
+                        }
+                        close(fd);
+                    }
+
+                    ~FileMapping() {
+                        if (data) {
+                            munmap(data, size);
+                        }
+                    }
+
+                    // hand the mapping over to an Image
+                    void* release() {
+                        return std::exchange(data, nullptr);
+                    }
+                };
+
+                // images are stored with rows starting at the bottom
+                void flipRows(unsigned char* pixels, int width, int height) {
+                    size_t rowBytes = static_cast<size_t>(width) * 4;
+                    for (int y = 0; y < height / 2; ++y) {
+                        unsigned char* top = pixels + static_cast<size_t>(y) * rowBytes;
+                        unsigned char* bottom = pixels + static_cast<size_t>(height - 1 - y) * rowBytes;
+                        std::swap_ranges(top, top + rowBytes, bottom);
+                    }
+                }
+
+                bool createDirectories(const std::string& path) {
+                    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+                        std::string part = path.substr(0, pos);
+                        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+                            return false;
+                        }
+                        if (pos == std::string::npos) {
+                            return true;
+                        }
+                    }
+                }
+
+            }
+
+            Image::Image() : m_width(0), m_height(0), m_pixels(nullptr), m_mapping(nullptr), m_mappingSize(0) {}
+
+            Image::Image(int width, int height, unsigned char* pixels)
+                : m_width(width), m_height(height), m_pixels(pixels), m_mapping(nullptr), m_mappingSize(0) {}
+
+            Image::Image(int width, int height, void* mapping, size_t mappingSize, size_t offset)
+                : m_width(width),
+                m_height(height),
+                m_pixels(static_cast<const unsigned char*>(mapping) + offset),
+                m_mapping(mapping),
+                m_mappingSize(mappingSize) {}
+
+            Image::Image(Image&& other)
+                : m_width(other.m_width),
+                m_height(other.m_height),
+                m_pixels(std::exchange(other.m_pixels, nullptr)),
+                m_mapping(std::exchange(other.m_mapping, nullptr)),
+                m_mappingSize(other.m_mappingSize) {}
+
+            Image& Image::operator=(Image&& other) {
+                if (this != &other) {
+                    release();
+                    m_width = other.m_width;
+                    m_height = other.m_height;
+                    m_pixels = std::exchange(other.m_pixels, nullptr);
+                    m_mapping = std::exchange(other.m_mapping, nullptr);
+                    m_mappingSize = other.m_mappingSize;
+                }
+                return *this;
+            }
+
+            Image::~Image() {
+                release();
+            }
+
+            void Image::release() {
+                if (m_mapping) {
+                    munmap(m_mapping, m_mappingSize);
+                } else if (m_pixels) {
+                    stbi_image_free(const_cast<unsigned char*>(m_pixels));
+                }
+                m_pixels = nullptr;
+                m_mapping = nullptr;
+            }
+
+            TextureCache::TextureCache(const std::string& directory) : TextureCache(directory, DEFAULT_MAX_BYTES) {}
+
+            TextureCache::TextureCache(const std::string& directory, uint64_t maxBytes)
+                : m_directory(directory),
+                m_maxBytes(maxBytes),
+                m_storedBytes(0),
+                m_evictMutex(),
+                m_hits(0),
+                m_misses(0) {
+                if (!m_directory.empty() && !createDirectories(m_directory)) {
+                    TME_WARN("could not create texture cache directory {}, not storing decoded textures", m_directory);
+                    m_directory.clear();
+                }
+                m_storedBytes = countStoredBytes();
+                TME_INFO("created {}", *this);
+            }
+
+            TextureCache::~TextureCache() {
+                TME_INFO("deleting {}", *this);
+            }
+
+            TextureCache& TextureCache::global() {
+                s_globalCreated = true;
+                static TextureCache cache(s_globalDirectory ? *s_globalDirectory : []() -> std::string {
+                    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+                        return std::string(cacheHome) + "/tme/textures";
+                    }
+                    if (const char* home = std::getenv("HOME"); home && *home) {
+                        return std::string(home) + "/.cache/tme/textures";
+                    }
+                    return "";
+                }(), s_globalMaxBytes);
+                return cache;
+            }
+
+            void TextureCache::configureGlobal(const std::string& directory, uint64_t maxBytes) {
+                TME_ASSERT(!s_globalCreated, "the global texture cache has been created already");
+                s_globalDirectory = directory;
+                s_globalMaxBytes = maxBytes;
+            }
+
+            Image TextureCache::load(const std::string& filePath) {
+                FileMapping file(filePath);
+                if (!file.data) {
+                    return Image();
+                }
+                const auto* content = static_cast<const unsigned char*>(file.data);
+                uint64_t contentHash = hash(content, file.size);
+                if (Image cached = find(contentHash); cached.getPixels()) {
+                    ++m_hits;
+                    return cached;
+                }
+                ++m_misses;
+                if (file.size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+                    TME_WARN("image file {} is too large to be decoded", filePath);
+                    return Image();
+                }
+                // the file is mapped already, decode it from memory instead of reading it again
+                int width = 0, height = 0, channels = 0;
+                unsigned char* pixels = stbi_load_from_memory(content, static_cast<int>(file.size), &width, &height, &channels, 4);
+                if (!pixels) {
+                    return Image();
+                }
+                // not flipped through stbi_set_flip_vertically_on_load, its flag is global to the process and loads run on several threads
+                flipRows(pixels, width, height);
+                Image image(width, height, pixels);
+                store(contentHash, image);
+                return image;
+            }
+
+            uint64_t TextureCache::hash(const unsigned char* data, size_t size) {
+                uint64_t result = 14695981039346656037ull;
+                for (size_t i = 0; i < size; ++i) {
+                    result ^= data[i];
+                    result *= 1099511628211ull;
+                }
+                return result;
+            }
+
+            std::string TextureCache::getEntryPath(uint64_t contentHash) const {
+                std::stringstream ss;
+                ss << m_directory << '/' << std::hex << std::setw(16) << std::setfill('0') << contentHash << ".rgba";
+                return ss.str();
+            }
+
+            Image TextureCache::find(uint64_t contentHash) const {
+                if (m_directory.empty()) {
+                    return Image();
+                }
+                FileMapping entry(getEntryPath(contentHash));
+                if (!entry.data || entry.size < sizeof(EntryHeader)) {
+                    return Image();
+                }
+                const auto* header = static_cast<const EntryHeader*>(entry.data);
+                size_t pixelBytes = static_cast<size_t>(header->width) * static_cast<size_t>(header->height) * 4;
+                if (std::memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 || header->version != VERSION
+                        || header->contentHash != contentHash || header->width <= 0 || header->height <= 0
+                        || entry.size != sizeof(EntryHeader) + pixelBytes) {
+                    TME_WARN("ignoring invalid texture cache entry {}", getEntryPath(contentHash));
+                    return Image();
+                }
+                // the modification time of an entry is the time of its last use
+                utime(getEntryPath(contentHash).c_str(), nullptr);
+                size_t size = entry.size;
+                return Image(header->width, header->height, entry.release(), size, sizeof(EntryHeader));
+            }
+
+            void TextureCache::store(uint64_t contentHash, const Image& image) {
+                if (m_directory.empty()) {
+                    return;
+                }
+                std::string entryPath = getEntryPath(contentHash);
+                // unique per thread, concurrent misses of the same file must not write into the same file
+                std::stringstream tempPath;
+                tempPath << entryPath << '.' << getpid() << '.' << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+                EntryHeader header;
+                std::memcpy(header.magic, s_magic, sizeof(s_magic));
+                header.version = VERSION;
+                header.width = image.getWidth();
+                header.height = image.getHeight();
+                header.contentHash = contentHash;
+                size_t pixelBytes = static_cast<size_t>(image.getWidth()) * static_cast<size_t>(image.getHeight()) * 4;
+
+                std::ofstream file(tempPath.str(), std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(image.getPixels()), static_cast<std::streamsize>(pixelBytes));
+                file.close();
+                if (!file || std::rename(tempPath.str().c_str(), entryPath.c_str()) != 0) {
+                    std::remove(tempPath.str().c_str());
+                    TME_WARN("could not store texture cache entry {}", entryPath);
+                    return;
+                }
+                if (m_storedBytes += sizeof(EntryHeader) + pixelBytes; m_storedBytes > m_maxBytes) {
+                    evict();
+                }
+            }
+
+            uint64_t TextureCache::countStoredBytes() const {
+                uint64_t bytes = 0;
+                if (!m_directory.empty()) {
+                    for (const auto& entry : listEntries(m_directory)) {
+                        bytes += entry.size;
+                    }
+                }
+                return bytes;
+            }
+
+            void TextureCache::evict() {
+                // other threads storing at the same time found the limit exceeded as well
+                std::lock_guard<std::mutex> lock(m_evictMutex);
+                std::vector<StoredEntry> entries = listEntries(m_directory);
+                uint64_t bytes = 0;
+                for (const auto& entry : entries) {
+                    bytes += entry.size;
+                }
+                // remove down to three quarters of the limit, so not every following store has to evict again
+                uint64_t target = m_maxBytes / 4 * 3;
+                if (bytes > m_maxBytes) {
+                    std::sort(entries.begin(), entries.end(), [](const StoredEntry& first, const StoredEntry& second) {
+                        return first.lastUse < second.lastUse;
+                    });
+                    for (auto iter = entries.begin(); iter != entries.end() && bytes > target; ++iter) {
+                        if (std::remove(iter->path.c_str()) == 0) {
+                            bytes -= iter->size;
+                        }
+                    }
+                    TME_INFO("evicted texture cache entries down to {} bytes", bytes);
+                }
+                m_storedBytes = bytes;
+            }
+
+            std::string TextureCache::toString() const {
+                std::stringstream ss;
+                ss << "TextureCache(" << m_directory << ',' << m_maxBytes << ',' << m_hits << ',' << m_misses << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
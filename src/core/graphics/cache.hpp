@@ -0,0 +1,216 @@
+#ifndef _CORE_GRAPHICS_CACHE_H
+#define _CORE_GRAPHICS_CACHE_H
+/** @file */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "core/loggable.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Decoded RGBA image with 8 bits per channel and rows starting at the bottom.
+             *
+             * The pixels are either owned by the image decoder or mapped from a TextureCache entry.
+             */
+            class Image final {
+                int m_width, m_height;
+                const unsigned char* m_pixels;
+                // mapped cache entry containing the pixels, nullptr if the pixels come from the decoder
+                void* m_mapping;
+                size_t m_mappingSize;
+
+                public:
+                /**//**
+                 * \brief Construct empty Image, used when an image could not be read.
+                 */
+                Image();
+                /**//**
+                 * \brief Take ownership of pixels allocated by the image decoder.
+                 *
+                 * @param width width in pixels
+                 * @param height height in pixels
+                 * @param pixels pixels returned by stbi_load
+                 */
+                Image(int width, int height, unsigned char* pixels);
+                /**//**
+                 * \brief Take ownership of a mapped cache entry.
+                 *
+                 * @param width width in pixels
+                 * @param height height in pixels
+                 * @param mapping start of the mapping
+                 * @param mappingSize size of the mapping in bytes
+                 * @param offset offset of the pixels inside the mapping
+                 */
+                Image(int width, int height, void* mapping, size_t mappingSize, size_t offset);
+                Image(Image&& other);
+                Image& operator=(Image&& other);
+                Image(const Image&) = delete;
+                Image& operator=(const Image&) = delete;
+                ~Image();
+
+                /**//**
+                 * \brief Get width of the image.
+                 *
+                 * @return width in pixels
+                 */
+                inline int getWidth() const { return m_width; }
+                /**//**
+                 * \brief Get height of the image.
+                 *
+                 * @return height in pixels
+                 */
+                inline int getHeight() const { return m_height; }
+                /**//**
+                 * \brief Get the pixels.
+                 *
+                 * @return RGBA pixels, nullptr if the image is empty
+                 */
+                inline const unsigned char* getPixels() const { return m_pixels; }
+                /**//**
+                 * \brief Check if the pixels are mapped from a cache entry.
+                 *
+                 * @return true if the image has been read from the cache
+                 */
+                inline bool isCached() const { return m_mapping != nullptr; }
+
+                private:
+                void release();
+            };
+
+            /**//**
+             * \brief Content addressed on-disk cache of decoded images.
+             *
+             * Entries are keyed by a hash of the content of the image file, so renamed or copied files still hit
+             * and changed files miss. An entry stores the decoded RGBA pixels and is mapped straight into memory,
+             * a cache hit skips decompressing the image completely.
+             * Every Texture format is uploaded from RGBA pixels, so one entry serves all formats.
+             * Entries are written to a temporary file first and renamed, several threads and processes can share a cache.
+             * Once the entries exceed the size limit, the least recently used ones are removed. Every hit refreshes
+             * the modification time of its entry, which serves as the time of its last use.
+             */
+            class TextureCache final : public Loggable {
+                public:
+                /**//**
+                 * \brief Header in front of the pixels of an entry.
+                 */
+                struct EntryHeader {
+                    char magic[4];
+                    uint32_t version;
+                    int32_t width;
+                    int32_t height;
+                    /// hash of the image file, guards against collisions of the file name
+                    uint64_t contentHash;
+                };
+
+                /// version of the entry layout, entries of other versions are decoded again
+                static constexpr uint32_t VERSION = 1;
+                /// size limit of the entries if none is given
+                static constexpr uint64_t DEFAULT_MAX_BYTES = 1024ull * 1024 * 1024;
+
+                private:
+                std::string m_directory;
+                uint64_t m_maxBytes;
+                // estimate of the size of all entries, recounted whenever entries are removed
+                std::atomic<uint64_t> m_storedBytes;
+                std::mutex m_evictMutex;
+                std::atomic<size_t> m_hits;
+                std::atomic<size_t> m_misses;
+
+                public:
+                /**//**
+                 * \brief Construct TextureCache storing its entries in directory.
+                 *
+                 * The directory is created if it does not exist yet.
+                 *
+                 * @param directory path to the directory of the entries, an empty path disables storing entries
+                 */
+                TextureCache(const std::string& directory);
+                /**//**
+                 * \brief Construct TextureCache storing at most maxBytes of entries in directory.
+                 *
+                 * @param directory path to the directory of the entries, an empty path disables storing entries
+                 * @param maxBytes size limit of all entries in bytes
+                 */
+                TextureCache(const std::string& directory, uint64_t maxBytes);
+                ~TextureCache();
+
+                /**//**
+                 * \brief Get the shared TextureCache.
+                 *
+                 * Unless configured otherwise, stores up to DEFAULT_MAX_BYTES of entries in $XDG_CACHE_HOME/tme/textures,
+                 * falling back to $HOME/.cache/tme/textures.
+                 *
+                 * @return reference to the TextureCache used by the application
+                 */
+                static TextureCache& global();
+                /**//**
+                 * \brief Configure the shared TextureCache.
+                 *
+                 * Has to be called before global() is called for the first time.
+                 *
+                 * @param directory path to the directory of the entries, an empty path disables storing entries
+                 * @param maxBytes size limit of all entries in bytes
+                 */
+                static void configureGlobal(const std::string& directory, uint64_t maxBytes);
+
+                /**//**
+                 * \brief Read an image file, using the cached pixels if possible.
+                 *
+                 * Decodes the file and adds an entry on a miss. May be called by several threads at once.
+                 *
+                 * @param filePath path to the image file
+                 *
+                 * @return the decoded Image, empty if the file could not be read or is too large to be decoded
+                 */
+                Image load(const std::string& filePath);
+
+                /**//**
+                 * \brief Hash the content of a file.
+                 *
+                 * @param data content of the file
+                 * @param size size of the content in bytes
+                 *
+                 * @return 64 bit FNV-1a hash of the content
+                 */
+                static uint64_t hash(const unsigned char* data, size_t size);
+
+                /**//**
+                 * \brief Get number of loads served from the cache.
+                 *
+                 * @return number of cache hits
+                 */
+                inline size_t getHits() const { return m_hits; }
+                /**//**
+                 * \brief Get number of loads which had to decode the file.
+                 *
+                 * @return number of cache misses
+                 */
+                inline size_t getMisses() const { return m_misses; }
+                /**//**
+                 * \brief Get the size limit of the entries.
+                 *
+                 * @return maximum number of bytes stored in the directory
+                 */
+                inline uint64_t getMaxBytes() const { return m_maxBytes; }
+
+                std::string toString() const override;
+
+                private:
+                std::string getEntryPath(uint64_t contentHash) const;
+                Image find(uint64_t contentHash) const;
+                void store(uint64_t contentHash, const Image& image);
+                uint64_t countStoredBytes() const;
+                void evict();
+            };
+
+        }
+    }
+}
+
+#endif
@@ -2,7 +2,10 @@
 
 #include "core/graphics/common.hpp"
 
+#include "core/graphics/atlas.hpp"
 #include "core/graphics/batch.hpp"
+#include "core/graphics/loader.hpp"
+#include "core/graphics/profiler.hpp"
 #include "core/graphics/shader.hpp"
 #include "core/graphics/texture.hpp"
 
@@ -18,6 +21,9 @@ namespace tme {
                 Storage<IndexBuffer>::global()->clear();
                 Storage<Shader>::global()->clear();
                 Storage<Shader::Stage>::global()->clear();
+                TextureLoader::global().clear();
+                Profiler::global().clear();
+                Atlas::global().clear();
                 Storage<Texture>::global()->clear();
             }
 
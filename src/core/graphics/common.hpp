@@ -84,7 +84,7 @@ namespace tme {
             class Bindable : public Mappable {
                 protected:
                 /// rendering id used to bind graphics object
-                Identifier m_renderingId = 0;
+                GLuint m_renderingId = 0;
 
                 public:
                 virtual ~Bindable() {}
@@ -7,9 +7,9 @@ namespace tme {
     namespace  core {
         namespace graphics {
 
-            IndexBuffer::IndexBuffer(GLsizeiptr primitivesPerEntry, GLsizeiptr entrySize, GLsizeiptr size)
-                : Buffer(GL_ELEMENT_ARRAY_BUFFER, entrySize, size),
-                m_primitiveCount(static_cast<GLsizei>(getSize() * primitivesPerEntry)) {
+            IndexBuffer::IndexBuffer(GLsizeiptr primitivesPerEntry, GLsizeiptr entrySize, GLsizeiptr size, bool streaming)
+                : Buffer(GL_ELEMENT_ARRAY_BUFFER, entrySize, size, streaming),
+                m_primitivesPerEntry(primitivesPerEntry) {
                 TME_INFO("created {}", *this);
             }
             IndexBuffer::~IndexBuffer() {
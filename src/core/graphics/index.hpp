@@ -15,19 +15,20 @@ namespace tme {
              * Additional functionality to get the amount of raw primitives inside the buffer for rendering.
              */
             class IndexBuffer final : public Buffer {
-                GLsizei m_primitiveCount;
+                GLsizeiptr m_primitivesPerEntry;
                 public:
                 /**//**
                  * \brief Construct Buffer instance for indices.
                  *
                  * Uses GL_ELEMENT_ARRAY_BUFFER for its type.
-                 * Precalculates amount of primitives stored inside the buffer.
+                 * Removed entries are overwritten with zeros which turns them into degenerate primitives.
                  *
                  * @param primitivesPerEntry number of primitives inside a single index entry
                  * @param entrySize size of a single index entry in bytes
                  * @param size number of index entries the buffer should be able to hold 
+                 * @param streaming true if updates should be collected until Buffer::flush() is called
                  */
-                IndexBuffer(GLsizeiptr primitivesPerEntry, GLsizeiptr entrySize, GLsizeiptr size);
+                IndexBuffer(GLsizeiptr primitivesPerEntry, GLsizeiptr entrySize, GLsizeiptr size, bool streaming = false);
                 ~IndexBuffer();
 
                 std::string toString() const override;
@@ -38,7 +39,15 @@ namespace tme {
                  *
                  * @return total number of primitives
                  */
-                inline GLsizei getPrimitiveCount() const { return m_primitiveCount;  }
+                inline GLsizei getPrimitiveCount() const { return static_cast<GLsizei>(getSize() * m_primitivesPerEntry);  }
+                /**//**
+                 * \brief Get number of primitives inside the used part of the buffer.
+                 *
+                 * Removed entries in between are included as degenerate primitives.
+                 *
+                 * @return number of primitives to be rendered
+                 */
+                inline GLsizei getUsedPrimitiveCount() const { return static_cast<GLsizei>(getUsedSize() * m_primitivesPerEntry);  }
             };
 
         }
@@ -0,0 +1,170 @@
+/** @file */
+#include "core/graphics/loader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include "core/graphics/state.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TextureLoader::TextureLoader(size_t workerCount)
+                : m_mutex(),
+                m_wakeUp(),
+                m_running(true),
+                m_jobs(),
+                m_results(),
+                m_pending(),
+                m_pixelBuffer(0),
+                m_workers() {
+                for (size_t i = 0; i < std::max<size_t>(workerCount, 1); ++i) {
+                    m_workers.emplace_back(&TextureLoader::run, this);
+                }
+                TME_INFO("created {}", *this);
+            }
+
+            TextureLoader::~TextureLoader() {
+                TME_INFO("deleting {}", *this);
+                {
+                    // a worker between checking the predicate and waiting would miss the notification otherwise
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_running = false;
+                }
+                m_wakeUp.notify_all();
+                for (auto& worker : m_workers) {
+                    worker.join();
+                }
+                if (m_pixelBuffer) {
+                    glCall(glDeleteBuffers(1, &m_pixelBuffer));
+                    State::global().forgetBuffer(m_pixelBuffer);
+                }
+            }
+
+            TextureLoader& TextureLoader::global() {
+                // leave a core to the render thread
+                size_t cores = std::thread::hardware_concurrency();
+                static TextureLoader loader(std::clamp<size_t>(cores > 1 ? cores - 1 : 1, 1, 4));
+                return loader;
+            }
+
+            Handle<Texture> TextureLoader::load(const std::string& filePath, Callback callback, const Texture::Options& options) {
+                // magenta and black checker board, so a missing image stands out
+                const unsigned char placeholder[] = {
+                    255, 0, 255, 255,   0, 0, 0, 255,
+                    0, 0, 0, 255,   255, 0, 255, 255
+                };
+                auto texture = Storage<Texture>::global()->add(new Texture(filePath, 2, 2, placeholder, options));
+                // keyed by the unique id, a destroyed placeholder may still be pending when its OpenGL name is reused
+                m_pending.insert({texture->getUniqueId(), {texture, callback}});
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_jobs.push_back({texture->getUniqueId(), filePath});
+                }
+                m_wakeUp.notify_one();
+                return texture;
+            }
+
+            size_t TextureLoader::update() {
+                std::deque<Result> results;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    size_t bytes = 0;
+                    while (!m_results.empty() && (results.empty() || bytes < s_uploadBudget)) {
+                        bytes += static_cast<size_t>(m_results.front().image.getWidth()) * static_cast<size_t>(m_results.front().image.getHeight()) * 4;
+                        results.push_back(std::move(m_results.front()));
+                        m_results.pop_front();
+                    }
+                }
+
+                size_t finished = 0;
+                for (auto& result : results) {
+                    auto iter = m_pending.find(result.texture);
+                    if (iter == m_pending.end()) {
+                        continue;
+                    }
+                    Pending pending = std::move(iter->second);
+                    m_pending.erase(iter);
+                    auto texture = pending.texture.lock();
+                    // the placeholder has been removed while the image was decoded
+                    if (!texture) {
+                        continue;
+                    }
+                    ++finished;
+                    if (!result.image.getPixels()) {
+                        TME_ERROR("could not read image file {}", texture->getFilePath());
+                        Storage<Texture>::global()->destroy(texture->getId());
+                        texture = nullptr;
+                    } else {
+                        upload(*texture, result);
+                        TME_INFO("loaded {}", *texture);
+                    }
+                    if (pending.callback) {
+                        pending.callback(texture);
+                    }
+                }
+                return finished;
+            }
+
+            void TextureLoader::upload(Texture& texture, const Result& result) {
+                if (!m_pixelBuffer) {
+                    glCall(glGenBuffers(1, &m_pixelBuffer));
+                }
+                size_t size = static_cast<size_t>(result.image.getWidth()) * static_cast<size_t>(result.image.getHeight()) * 4;
+                State::global().bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+                // orphan the previous storage, so the copy does not wait for the last upload to finish
+                glCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW));
+                glCall(void* target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+                if (target) {
+                    std::memcpy(target, result.image.getPixels(), size);
+                    glCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+                    texture.load(result.image.getWidth(), result.image.getHeight(), nullptr);
+                    State::global().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                } else {
+                    TME_WARN("could not map pixel buffer, uploading {} directly", texture);
+                    State::global().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    texture.load(result.image.getWidth(), result.image.getHeight(), result.image.getPixels());
+                }
+            }
+
+            void TextureLoader::clear() {
+                m_pending.clear();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_jobs.clear();
+                    m_results.clear();
+                }
+                if (m_pixelBuffer) {
+                    glCall(glDeleteBuffers(1, &m_pixelBuffer));
+                    State::global().forgetBuffer(m_pixelBuffer);
+                    m_pixelBuffer = 0;
+                }
+            }
+
+            void TextureLoader::run() {
+                while (true) {
+                    Job job;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wakeUp.wait(lock, [this]() { return !m_running || !m_jobs.empty(); });
+                        if (!m_running) {
+                            return;
+                        }
+                        job = std::move(m_jobs.front());
+                        m_jobs.pop_front();
+                    }
+                    Result result{job.texture, TextureCache::global().load(job.filePath)};
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_results.push_back(std::move(result));
+                }
+            }
+
+            std::string TextureLoader::toString() const {
+                std::stringstream ss;
+                ss << "TextureLoader(" << m_workers.size() << ',' << m_pending.size() << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
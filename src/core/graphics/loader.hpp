@@ -0,0 +1,137 @@
+#ifndef _CORE_GRAPHICS_LOADER_H
+#define _CORE_GRAPHICS_LOADER_H
+/** @file */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "core/graphics/cache.hpp"
+#include "core/graphics/texture.hpp"
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Loads image files into textures without blocking the render thread.
+             *
+             * load() immediately returns a pending placeholder Texture in the global Storage.
+             * The image is decoded by a pool of worker threads through the global TextureCache, the decoded pixels are uploaded
+             * through a pixel buffer object by update() on the thread owning the OpenGL context.
+             * The placeholder keeps its id, so everything referencing it shows the image once it is loaded.
+             */
+            class TextureLoader final : public Loggable {
+                public:
+                /**//**
+                 * \brief Called on the render thread once a texture has been loaded.
+                 *
+                 * Receives the loaded Texture or nullptr if the image could not be read,
+                 * in which case the placeholder has been removed from the global Storage.
+                 */
+                using Callback = std::function<void(Handle<Texture>)>;
+
+                private:
+                struct Job {
+                    // unique id of the placeholder
+                    Identifier texture;
+                    std::string filePath;
+                };
+
+                struct Result {
+                    Identifier texture;
+                    // empty if decoding failed
+                    Image image;
+                };
+
+                struct Pending {
+                    std::weak_ptr<Texture> texture;
+                    Callback callback;
+                };
+
+                // upper bound of bytes uploaded per update, at least one texture is uploaded regardless
+                static constexpr size_t s_uploadBudget = 16 * 1024 * 1024;
+
+                std::mutex m_mutex;
+                std::condition_variable m_wakeUp;
+                // all guarded by m_mutex, workers pull jobs and push results until they are stopped
+                bool m_running;
+                std::deque<Job> m_jobs;
+                std::deque<Result> m_results;
+                // only accessed by the render thread, keyed by the unique id of the placeholder
+                std::unordered_map<Identifier, Pending> m_pending;
+                GLuint m_pixelBuffer;
+                std::vector<std::thread> m_workers;
+
+                public:
+                /**//**
+                 * \brief Start the worker threads.
+                 *
+                 * @param workerCount number of threads decoding images, at least one
+                 */
+                TextureLoader(size_t workerCount);
+                ~TextureLoader();
+
+                /**//**
+                 * \brief Get the shared TextureLoader.
+                 *
+                 * Uses up to four workers, depending on the available cores.
+                 * Its pending loads and OpenGL objects are released by graphics::cleanUp().
+                 *
+                 * @return reference to the TextureLoader used by the application
+                 */
+                static TextureLoader& global();
+
+                /**//**
+                 * \brief Start loading an image file.
+                 *
+                 * @param filePath path to the image file
+                 * @param callback invoked by update() when loading has finished, may be empty
+                 * @param options format and mipmapping of the loaded texture
+                 *
+                 * @return Handle to the pending placeholder Texture, already added to the global Storage
+                 */
+                Handle<Texture> load(const std::string& filePath, Callback callback = Callback(), const Texture::Options& options = Texture::defaultOptions());
+
+                /**//**
+                 * \brief Upload decoded images and invoke their callbacks.
+                 *
+                 * Has to be called regularly by the thread owning the OpenGL context.
+                 *
+                 * @return number of textures which have finished loading
+                 */
+                size_t update();
+
+                /**//**
+                 * \brief Get number of loads which have not finished yet.
+                 *
+                 * @return number of pending textures
+                 */
+                inline size_t getPendingCount() const { return m_pending.size(); }
+
+                /**//**
+                 * \brief Drop all pending loads and release the OpenGL objects.
+                 *
+                 * Callbacks of dropped loads are not invoked.
+                 */
+                void clear();
+
+                std::string toString() const override;
+
+                private:
+                void run();
+                void upload(Texture& texture, const Result& result);
+            };
+
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+/** @file */
+#include "core/graphics/profiler.hpp"
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+#include "core/graphics/state.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            Profiler::Scope::Scope(const std::string& name) : m_open(Profiler::global().isRecording()) {
+                if (m_open) {
+                    Profiler::global().begin(name);
+                }
+            }
+
+            Profiler::Scope::Scope(const char* kind, Identifier id) : m_open(Profiler::global().isRecording()) {
+                if (m_open) {
+                    Profiler::global().begin(std::string(kind) + ' ' + std::to_string(id));
+                }
+            }
+
+            Profiler::Scope::Scope(const Loggable& object) : m_open(Profiler::global().isRecording()) {
+                if (m_open) {
+                    Profiler::global().begin(object.toString());
+                }
+            }
+
+            Profiler::Scope::~Scope() {
+                if (m_open) {
+                    Profiler::global().end();
+                }
+            }
+
+            Profiler::Profiler()
+                : m_enabled(false),
+                m_nextEnabled(false),
+                m_inFrame(false),
+                m_frameNumber(0),
+                m_current(0),
+                m_frames(),
+                m_open(),
+                m_sections(),
+                m_order() {
+                TME_INFO("created {}", *this);
+            }
+
+            Profiler::~Profiler() {
+                TME_INFO("deleting {}", *this);
+            }
+
+            Profiler& Profiler::global() {
+                static Profiler profiler;
+                return profiler;
+            }
+
+            void Profiler::beginFrame() {
+                if (m_inFrame) {
+                    return;
+                }
+                m_enabled = m_nextEnabled;
+                if (!m_enabled) {
+                    return;
+                }
+                m_current = (m_current + 1) % s_frameCount;
+                Frame& frame = m_frames[m_current];
+                if (frame.pending) {
+                    resolve(frame);
+                }
+                frame.records.clear();
+                frame.number = ++m_frameNumber;
+                m_inFrame = true;
+                begin("Frame");
+            }
+
+            void Profiler::endFrame() {
+                if (!m_inFrame) {
+                    return;
+                }
+                // close sections left open by exceptions along with the frame
+                while (!m_open.empty()) {
+                    end();
+                }
+                m_frames[m_current].pending = true;
+                m_inFrame = false;
+            }
+
+            void Profiler::begin(const std::string& name) {
+                if (!m_inFrame) {
+                    return;
+                }
+                Frame& frame = m_frames[m_current];
+                auto [iter, inserted] = m_sections.try_emplace({m_open.size(), name});
+                Section& section = iter->second;
+                if (inserted) {
+                    section.name = name;
+                    section.depth = m_open.size();
+                }
+                section.lastFrame = frame.number;
+                size_t index = frame.records.size();
+                if (frame.queries.size() < 2 * (index + 1)) {
+                    size_t count = frame.queries.size();
+                    // grows like the records, so the pool settles after the first frames
+                    frame.queries.resize(std::max<size_t>(2 * (index + 1), 2 * count));
+                    glCall(glGenQueries(static_cast<GLsizei>(frame.queries.size() - count), &frame.queries[count]));
+                }
+                frame.records.push_back({&section, std::chrono::steady_clock::now(), snapshot()});
+                m_open.push_back(index);
+                glCall(glQueryCounter(frame.queries[2 * index], GL_TIMESTAMP));
+            }
+
+            void Profiler::end() {
+                if (!m_inFrame || m_open.empty()) {
+                    return;
+                }
+                Frame& frame = m_frames[m_current];
+                size_t index = m_open.back();
+                m_open.pop_back();
+                glCall(glQueryCounter(frame.queries[2 * index + 1], GL_TIMESTAMP));
+                Record& record = frame.records[index];
+                Statistics current = snapshot();
+                record.statistics.cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - record.start).count();
+                record.statistics.drawCalls = current.drawCalls - record.statistics.drawCalls;
+                record.statistics.primitives = current.primitives - record.statistics.primitives;
+                record.statistics.stateChanges = current.stateChanges - record.statistics.stateChanges;
+                record.statistics.uploadedBytes = current.uploadedBytes - record.statistics.uploadedBytes;
+            }
+
+            void Profiler::resolve(Frame& frame) {
+                frame.pending = false;
+                // the end of the first record is the last timestamp of the frame
+                GLint available = 0;
+                if (!frame.records.empty()) {
+                    glCall(glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available));
+                }
+
+                std::unordered_map<const Section*, Statistics> sums;
+                m_order.clear();
+                for (size_t i = 0; i < frame.records.size(); ++i) {
+                    const Record& record = frame.records[i];
+                    auto [iter, inserted] = sums.insert({record.section, Statistics()});
+                    if (inserted) {
+                        m_order.push_back(record.section);
+                        // keeps the previous GPU time if the queries are not available yet
+                        iter->second.gpuTime = available ? 0.0 : record.section->statistics.gpuTime;
+                    }
+                    Statistics& sum = iter->second;
+                    sum.cpuTime += record.statistics.cpuTime;
+                    sum.drawCalls += record.statistics.drawCalls;
+                    sum.primitives += record.statistics.primitives;
+                    sum.stateChanges += record.statistics.stateChanges;
+                    sum.uploadedBytes += record.statistics.uploadedBytes;
+                    if (available) {
+                        GLuint64 start = 0, end = 0;
+                        glCall(glGetQueryObjectui64v(frame.queries[2 * i], GL_QUERY_RESULT, &start));
+                        glCall(glGetQueryObjectui64v(frame.queries[2 * i + 1], GL_QUERY_RESULT, &end));
+                        sum.gpuTime += static_cast<double>(end - start) / 1.0e6;
+                    }
+                }
+
+                for (auto iter = m_sections.begin(); iter != m_sections.end();) {
+                    Section& section = iter->second;
+                    // sections which have not been used for a while are dropped, those of the recorded frames are kept
+                    if (m_frameNumber - section.lastFrame > HISTORY_SIZE) {
+                        iter = m_sections.erase(iter);
+                        continue;
+                    }
+                    auto sum = sums.find(&section);
+                    section.statistics = sum != sums.end() ? sum->second : Statistics();
+                    section.cpuHistory[section.historyOffset] = static_cast<float>(section.statistics.cpuTime);
+                    section.gpuHistory[section.historyOffset] = static_cast<float>(section.statistics.gpuTime);
+                    section.historyOffset = (section.historyOffset + 1) % HISTORY_SIZE;
+                    ++iter;
+                }
+            }
+
+            Profiler::Statistics Profiler::snapshot() {
+                const State& state = State::global();
+                Statistics statistics;
+                statistics.drawCalls = state.getDrawCount();
+                statistics.primitives = state.getPrimitiveCount();
+                statistics.stateChanges = state.getCallCount();
+                statistics.uploadedBytes = state.getUploadedBytes();
+                return statistics;
+            }
+
+            void Profiler::clear() {
+                for (auto& frame : m_frames) {
+                    if (!frame.queries.empty()) {
+                        glCall(glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data()));
+                    }
+                    frame = Frame();
+                }
+                m_open.clear();
+                m_order.clear();
+                m_sections.clear();
+                m_inFrame = false;
+            }
+
+            std::string Profiler::toString() const {
+                std::stringstream ss;
+                ss << "Profiler(" << m_enabled << ',' << m_frameNumber << ',' << m_sections.size() << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
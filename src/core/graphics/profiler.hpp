@@ -0,0 +1,224 @@
+#ifndef _CORE_GRAPHICS_PROFILER_H
+#define _CORE_GRAPHICS_PROFILER_H
+/** @file */
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/graphics/common.hpp"
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Measures the time and draw statistics of named sections of a frame.
+             *
+             * Sections are opened with begin() and closed with end(), usually through a Scope, and may be nested.
+             * Every section records its CPU time and the draw calls, triangles, state changes and uploads counted by the
+             * global State while it is open. Its GPU time is measured with a pair of timestamp queries, which can nest
+             * unlike elapsed time queries. The queries of a frame are read when its buffer is reused two frames later,
+             * by then the GPU has usually finished the frame, so reading them does not stall. Results which are still
+             * not available are skipped and the previous GPU time of the section is kept.
+             * Sections of the same name and depth are summed up per frame. Nothing is recorded while the profiler is disabled.
+             */
+            class Profiler final : public Loggable {
+                public:
+                /// number of frames kept in the history of a section
+                static constexpr size_t HISTORY_SIZE = 120;
+
+                /**//**
+                 * \brief Measurements of a section during one frame.
+                 */
+                struct Statistics {
+                    /// time spent on the CPU in milliseconds
+                    double cpuTime = 0.0;
+                    /// time spent on the GPU in milliseconds
+                    double gpuTime = 0.0;
+                    /// number of draw calls
+                    size_t drawCalls = 0;
+                    /// number of drawn triangles
+                    size_t primitives = 0;
+                    /// number of state changes which reached OpenGL
+                    size_t stateChanges = 0;
+                    /// number of bytes uploaded to buffers
+                    size_t uploadedBytes = 0;
+                };
+
+                /**//**
+                 * \brief A named part of the frame.
+                 */
+                struct Section {
+                    /// name passed to begin()
+                    std::string name;
+                    /// number of sections the section is nested in
+                    size_t depth = 0;
+                    /// measurements of the last resolved frame
+                    Statistics statistics;
+                    /// CPU times of the last HISTORY_SIZE frames in milliseconds, starting at historyOffset
+                    std::vector<float> cpuHistory = std::vector<float>(HISTORY_SIZE, 0.0f);
+                    /// GPU times of the last HISTORY_SIZE frames in milliseconds, starting at historyOffset
+                    std::vector<float> gpuHistory = std::vector<float>(HISTORY_SIZE, 0.0f);
+                    /// index of the oldest entry of the histories
+                    size_t historyOffset = 0;
+                    /// last frame the section has been opened in
+                    uint64_t lastFrame = 0;
+                };
+
+                /**//**
+                 * \brief Opens a section for its lifetime.
+                 */
+                class Scope {
+                    bool m_open;
+
+                    public:
+                    /**//**
+                     * \brief Open a section.
+                     *
+                     * @param name name of the section
+                     */
+                    Scope(const std::string& name);
+                    /**//**
+                     * \brief Open a section named after an object.
+                     *
+                     * The name is only built while profiling.
+                     *
+                     * @param kind kind of the object
+                     * @param id Identifier of the object
+                     */
+                    Scope(const char* kind, Identifier id);
+                    /**//**
+                     * \brief Open a section named after the string representation of an object.
+                     *
+                     * The name is only built while profiling.
+                     *
+                     * @param object object the section is named after
+                     */
+                    Scope(const Loggable& object);
+                    /**//**
+                     * \brief Close the section.
+                     */
+                    ~Scope();
+
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+                };
+
+                private:
+                // frames recorded before their queries are read
+                static constexpr size_t s_frameCount = 2;
+
+                // a single begin() end() pair
+                struct Record {
+                    Section* section;
+                    std::chrono::steady_clock::time_point start;
+                    // counters of the State at begin(), replaced by their difference at end()
+                    Statistics statistics;
+                };
+
+                // records of a frame, the timestamps of record i are the queries 2i and 2i+1
+                struct Frame {
+                    std::vector<Record> records;
+                    std::vector<GLuint> queries;
+                    uint64_t number = 0;
+                    bool pending = false;
+                };
+
+                bool m_enabled;
+                bool m_nextEnabled;
+                bool m_inFrame;
+                uint64_t m_frameNumber;
+                size_t m_current;
+                Frame m_frames[s_frameCount];
+                // open records of the current frame
+                std::vector<size_t> m_open;
+                // node based, so records can point to the sections, keyed by depth and name
+                std::map<std::pair<size_t, std::string>, Section> m_sections;
+                // sections of the last resolved frame in the order they have been opened
+                std::vector<const Section*> m_order;
+
+                public:
+                /**//**
+                 * \brief Construct disabled Profiler.
+                 */
+                Profiler();
+                ~Profiler();
+
+                /**//**
+                 * \brief Get the Profiler of the application.
+                 *
+                 * @return reference to the global Profiler
+                 */
+                static Profiler& global();
+
+                /**//**
+                 * \brief Enable or disable profiling with the next frame.
+                 *
+                 * @param enabled true to record frames
+                 */
+                inline void setEnabled(bool enabled) { m_nextEnabled = enabled; }
+                /**//**
+                 * \brief Check if frames are recorded.
+                 *
+                 * @return true if enabled, the change of setEnabled() is applied with the next beginFrame()
+                 */
+                inline bool isEnabled() const { return m_nextEnabled; }
+                /**//**
+                 * \brief Check if a frame is being recorded.
+                 *
+                 * @return true between beginFrame() and endFrame() of an enabled Profiler
+                 */
+                inline bool isRecording() const { return m_inFrame; }
+
+                /**//**
+                 * \brief Start a frame.
+                 *
+                 * Resolves the frame recorded two frames ago and opens the section "Frame" containing all others.
+                 */
+                void beginFrame();
+                /**//**
+                 * \brief End the current frame.
+                 */
+                void endFrame();
+
+                /**//**
+                 * \brief Open a section inside the current frame.
+                 *
+                 * @param name name of the section
+                 */
+                void begin(const std::string& name);
+                /**//**
+                 * \brief Close the most recently opened section.
+                 */
+                void end();
+
+                /**//**
+                 * \brief Get the sections of the last resolved frame.
+                 *
+                 * @return sections in the order they have been opened, children directly follow their parent
+                 */
+                inline const std::vector<const Section*>& getSections() const { return m_order; }
+
+                /**//**
+                 * \brief Delete all queries and sections.
+                 *
+                 * Has to be called before the context is destroyed.
+                 */
+                void clear();
+
+                std::string toString() const override;
+
+                private:
+                void resolve(Frame& frame);
+                static Statistics snapshot();
+            };
+
+        }
+    }
+}
+
+#endif
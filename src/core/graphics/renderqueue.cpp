@@ -0,0 +1,77 @@
+/** @file */
+#include "core/graphics/renderqueue.hpp"
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include "core/graphics/profiler.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            RenderQueue::RenderQueue() : m_commands(), m_shaderRanks(), m_textureRanks(), m_stateChanges(0) {}
+
+            RenderQueue::~RenderQueue() {}
+
+            void RenderQueue::submit(uint16_t layer, BatchPool& pool, BatchPool::Key batch) {
+                const Batch* submitted = pool.find(batch);
+                if (!submitted) {
+                    return;
+                }
+                const auto& config = submitted->getConfig();
+                uint64_t key = makeKey(layer, rank(m_shaderRanks, config.shaderId), rank(m_textureRanks, config.textureId),
+                        static_cast<uint16_t>(submitted->getVertexArrayId()));
+                m_commands.push_back({key, &pool, batch});
+            }
+
+            void RenderQueue::flush() {
+                // stable, so batches with equal keys keep their submission order
+                std::stable_sort(m_commands.begin(), m_commands.end(), [](const Command& lhs, const Command& rhs) {
+                    return lhs.key < rhs.key;
+                });
+                m_stateChanges = 0;
+                const Batch::Config* previous = nullptr;
+                // the layers only submit their batches, so their draws are profiled here
+                std::optional<Profiler::Scope> layerScope;
+                uint16_t layer = 0;
+                for (auto& command : m_commands) {
+                    Batch* batch = command.pool->find(command.batch);
+                    if (!batch) {
+                        continue;
+                    }
+                    uint16_t commandLayer = static_cast<uint16_t>(command.key >> 48);
+                    if (!layerScope || commandLayer != layer) {
+                        layerScope.emplace("Layer", commandLayer);
+                        layer = commandLayer;
+                    }
+                    const auto& config = batch->getConfig();
+                    if (!previous || previous->preRender != config.preRender
+                            || previous->shaderId != config.shaderId || previous->textureId != config.textureId) {
+                        config.preRender(config.shaderId, config.textureId);
+                        ++m_stateChanges;
+                    }
+                    batch->draw();
+                    previous = &config;
+                }
+                m_commands.clear();
+            }
+
+            uint64_t RenderQueue::makeKey(uint16_t layer, uint16_t shader, uint16_t texture, uint16_t vertexArray) {
+                return static_cast<uint64_t>(layer) << 48 | static_cast<uint64_t>(shader) << 32
+                    | static_cast<uint64_t>(texture) << 16 | vertexArray;
+            }
+
+            uint16_t RenderQueue::rank(std::unordered_map<Identifier, uint16_t>& ranks, Identifier id) {
+                // ranks wrap around after 65536 ids, that only makes grouping less effective
+                return ranks.insert({id, static_cast<uint16_t>(ranks.size())}).first->second;
+            }
+
+            std::string RenderQueue::toString() const {
+                std::stringstream ss;
+                ss << "RenderQueue(" << m_commands.size() << ',' << m_stateChanges << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef _CORE_GRAPHICS_RENDERQUEUE_H
+#define _CORE_GRAPHICS_RENDERQUEUE_H
+/** @file */
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "core/graphics/batch.hpp"
+#include "core/loggable.hpp"
+#include "core/storage.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Collects the batches of a frame and renders them sorted by their state.
+             *
+             * Every submitted Batch gets a 64 bit key made up of, from the most significant bits,
+             * layer, shader, texture and vertex array. Sorting by the key keeps the layers in order,
+             * so blending stays correct, and groups batches sharing a shader and texture inside a layer.
+             * The preRender hook is only called when the hook, shader or texture change between two batches.
+             * Batches of one layer must not overlap, their order inside the layer is not defined.
+             * The draws of each layer are profiled in a section named "Layer" followed by the layer number.
+             */
+            class RenderQueue final : public Loggable {
+                public:
+                /**//**
+                 * \brief A batch waiting to be rendered.
+                 */
+                struct Command {
+                    /// sort key of the batch
+                    uint64_t key;
+                    /// pool containing the batch, has to outlive flush()
+                    BatchPool* pool;
+                    /// Key of the batch inside the pool, resolved by flush() as batches may move when the pool grows
+                    BatchPool::Key batch;
+                };
+
+                private:
+                std::vector<Command> m_commands;
+                // shaders and textures are numbered in order of appearance to fit their ids into the key
+                std::unordered_map<Identifier, uint16_t> m_shaderRanks;
+                std::unordered_map<Identifier, uint16_t> m_textureRanks;
+                size_t m_stateChanges;
+
+                public:
+                /**//**
+                 * \brief Construct empty RenderQueue.
+                 */
+                RenderQueue();
+                ~RenderQueue();
+
+                /**//**
+                 * \brief Add a batch of a pool to be rendered with the next flush().
+                 *
+                 * The batch is looked up again by the flush, so batches may be created in the pool in between.
+                 * Batches which have been removed from the pool by then are skipped.
+                 *
+                 * @param layer position in the draw order, lower layers are drawn first
+                 * @param pool the BatchPool containing the batch, has to outlive the flush
+                 * @param batch Key of the Batch to be rendered
+                 */
+                void submit(uint16_t layer, BatchPool& pool, BatchPool::Key batch);
+
+                /**//**
+                 * \brief Render and remove all submitted batches.
+                 */
+                void flush();
+
+                /**//**
+                 * \brief Build a sort key.
+                 *
+                 * @param layer position in the draw order
+                 * @param shader rank of the shader
+                 * @param texture rank of the texture
+                 * @param vertexArray OpenGL name of the vertex array
+                 *
+                 * @return key ordering by layer first, then shader, texture and vertex array
+                 */
+                static uint64_t makeKey(uint16_t layer, uint16_t shader, uint16_t texture, uint16_t vertexArray);
+
+                /**//**
+                 * \brief Get number of submitted batches.
+                 *
+                 * @return number of batches waiting for flush()
+                 */
+                inline size_t getCommandCount() const { return m_commands.size(); }
+                /**//**
+                 * \brief Get number of preRender hooks called by the last flush().
+                 *
+                 * @return number of shader and texture changes of the last frame
+                 */
+                inline size_t getStateChanges() const { return m_stateChanges; }
+
+                std::string toString() const override;
+
+                private:
+                static uint16_t rank(std::unordered_map<Identifier, uint16_t>& ranks, Identifier id);
+            };
+
+        }
+    }
+}
+
+#endif
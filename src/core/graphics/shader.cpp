@@ -4,6 +4,7 @@
 #include <sstream>
 #include "core/graphics/shader.hpp"
 #include "core/storage.hpp"
+#include "core/graphics/state.hpp"
 #include "core/exceptions/input.hpp"
 #include "core/exceptions/validation.hpp"
 
@@ -63,7 +64,7 @@ namespace tme {
 
 
             Shader::Shader(Handle<Shader::Stage> vertexStage, Handle<Shader::Stage> fragmentStage)
-                : m_stages(), m_uniformCache() {
+                : m_stages(), m_uniformCache(), m_uniformBlockBindings() {
                 TME_ASSERT(vertexStage, "provided invalid vertex stage");
                 TME_ASSERT(fragmentStage, "provided invalid fragment stage");
 
@@ -72,8 +73,8 @@ namespace tme {
                 m_stages.insert({Stage::Type::Fragment, fragmentStage->getId()});
 
                 glCall(m_renderingId = glCreateProgram());
-                glCall(glAttachShader(m_renderingId, vertexStage->getId()));
-                glCall(glAttachShader(m_renderingId, fragmentStage->getId()));
+                glCall(glAttachShader(m_renderingId, static_cast<GLuint>(vertexStage->getId())));
+                glCall(glAttachShader(m_renderingId, static_cast<GLuint>(fragmentStage->getId())));
 
                 glCall(glLinkProgram(m_renderingId));
                 if (!logGLStatus(GL_STATUS_FNS(Program), m_renderingId, GL_LINK_STATUS)) {
@@ -100,6 +101,7 @@ namespace tme {
             void Shader::cleanUp() {
                 unbind();
                 glCall(glDeleteProgram(m_renderingId));
+                State::global().forgetProgram(m_renderingId);
                 for (const auto stageIter : m_stages) {
                     Storage<Stage>::global()->destroy(stageIter.second);
                 }
@@ -115,17 +117,21 @@ namespace tme {
             }
 
             void Shader::bind() const {
-                glCall(glUseProgram(m_renderingId));
+                State::global().useProgram(m_renderingId);
             }
 
             void Shader::unbind() const {
-                glCall(glUseProgram(0));
+                State::global().useProgram(0);
             }
 
             void Shader::setUniform1i(const std::string& name, int value) {
                 glCall(glUniform1i(getUniformLocation(name), value));
             }
 
+            void Shader::setUniform1f(const std::string& name, float value) {
+                glCall(glUniform1f(getUniformLocation(name), value));
+            }
+
             void Shader::setUniform4f(const std::string& name, float v0, float v1, float v2, float v3) {
                 glCall(glUniform4f(getUniformLocation(name), v0, v1, v2, v3));
             }
@@ -134,6 +140,19 @@ namespace tme {
                 glCall(glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
             }
 
+            void Shader::setUniformBlock(const std::string& name, GLuint binding) {
+                if (auto iter = m_uniformBlockBindings.find(name); iter != m_uniformBlockBindings.end() && iter->second == binding) {
+                    return;
+                }
+                glCall(GLuint index = glGetUniformBlockIndex(m_renderingId, name.c_str()));
+                if (index == GL_INVALID_INDEX) {
+                    TME_WARN("unknown uniform block '{}' for shader {}", name, m_renderingId);
+                    return;
+                }
+                glCall(glUniformBlockBinding(m_renderingId, index, binding));
+                m_uniformBlockBindings[name] = binding;
+            }
+
             GLint Shader::getUniformLocation(const std::string& name) {
                 if(m_uniformCache.find(name) != m_uniformCache.end()) {
                     return m_uniformCache[name];
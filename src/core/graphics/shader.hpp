@@ -70,7 +70,7 @@ namespace tme {
                     std::string toString() const override;
 
                     private:
-                    Identifier m_id;
+                    GLuint m_id;
                     Type m_type;
                     std::string m_filePath;
                     std::string m_name;
@@ -82,6 +82,8 @@ namespace tme {
                 std::unordered_map<Stage::Type, core::Identifier> m_stages;
                 std::string m_name;
                 std::unordered_map<std::string, GLint> m_uniformCache;
+                // binding point assigned to each uniform block
+                std::unordered_map<std::string, GLuint> m_uniformBlockBindings;
 
                 public:
                 /**//**
@@ -114,6 +116,14 @@ namespace tme {
                  * @return custom set name of the stage
                  */
                 inline std::string getName() const { return m_name; }
+                /**//**
+                 * \brief Get a Stage of the Shader.
+                 *
+                 * @param type the type of the requested Stage
+                 *
+                 * @return global Identifier of the Stage
+                 */
+                inline Identifier getStage(Stage::Type type) const { return m_stages.at(type); }
 
                 void bind() const override;
                 void unbind() const override;
@@ -125,6 +135,13 @@ namespace tme {
                  * @param value value the uniform should be set to
                  */
                 void setUniform1i(const std::string& name, int value);
+                /**//**
+                 * \brief Set one float uniform.
+                 *
+                 * @param name name of the uniform
+                 * @param value value the uniform should be set to
+                 */
+                void setUniform1f(const std::string& name, float value);
                 /**//**
                  * \brief Set four float uniform.
                  *
@@ -139,6 +156,13 @@ namespace tme {
                  * @param matrix matrix the uniform should be set to
                  */
                 void setUniformMat4f(const std::string& name, const glm::mat4& matrix);
+                /**//**
+                 * \brief Assign a uniform block to a buffer binding point.
+                 *
+                 * @param name name of the uniform block
+                 * @param binding index of the GL_UNIFORM_BUFFER binding point the block reads from
+                 */
+                void setUniformBlock(const std::string& name, GLuint binding);
 
                 std::string toString() const override;
 
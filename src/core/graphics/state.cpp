@@ -0,0 +1,250 @@
+/** @file */
+#include "core/graphics/state.hpp"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            State::State()
+                : m_program(s_unknown),
+                m_vertexArray(s_unknown),
+                m_elementBuffers(),
+                m_buffers(),
+                m_indexedBuffers(),
+                m_textures(),
+                m_lastUse(),
+                m_textureSlots(),
+                m_activeSlot(s_unknown),
+                m_clock(0),
+                m_blend(s_unknown),
+                m_blendSource(GL_ONE),
+                m_blendDestination(GL_ZERO),
+                m_calls(0),
+                m_skipped(0),
+                m_uploaded(0),
+                m_draws(0),
+                m_primitives(0) {}
+
+            State::~State() {}
+
+            State& State::global() {
+                static State state;
+                return state;
+            }
+
+            void State::useProgram(GLuint program) {
+                if (program == m_program) {
+                    ++m_skipped;
+                    return;
+                }
+                glCall(glUseProgram(program));
+                m_program = program;
+                ++m_calls;
+            }
+
+            void State::bindVertexArray(GLuint vertexArray) {
+                if (vertexArray == m_vertexArray) {
+                    ++m_skipped;
+                    return;
+                }
+                glCall(glBindVertexArray(vertexArray));
+                m_vertexArray = vertexArray;
+                ++m_calls;
+            }
+
+            void State::bindBuffer(GLenum target, GLuint buffer) {
+                if (target == GL_ELEMENT_ARRAY_BUFFER) {
+                    // the binding belongs to the vertex array, it can only be tracked if the vertex array is known
+                    if (m_vertexArray != s_unknown) {
+                        auto [iter, inserted] = m_elementBuffers.insert({m_vertexArray, buffer});
+                        if (!inserted && iter->second == buffer) {
+                            ++m_skipped;
+                            return;
+                        }
+                        iter->second = buffer;
+                    }
+                } else {
+                    auto [iter, inserted] = m_buffers.insert({target, buffer});
+                    if (!inserted && iter->second == buffer) {
+                        ++m_skipped;
+                        return;
+                    }
+                    iter->second = buffer;
+                }
+                glCall(glBindBuffer(target, buffer));
+                ++m_calls;
+            }
+
+            void State::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+                auto [iter, inserted] = m_indexedBuffers.insert({{target, index}, buffer});
+                if (!inserted && iter->second == buffer) {
+                    ++m_skipped;
+                    return;
+                }
+                iter->second = buffer;
+                glCall(glBindBufferBase(target, index, buffer));
+                m_buffers[target] = buffer;
+                ++m_calls;
+            }
+
+            GLenum State::bindTexture(GLuint texture) {
+                if (m_textures.empty()) {
+                    // the limit is only known once a context exists
+                    GLint units = 0;
+                    glCall(glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &units));
+                    m_textures.assign(static_cast<size_t>(std::max(units, 1)), 0);
+                    m_lastUse.assign(m_textures.size(), 0);
+                }
+                GLenum slot;
+                auto iter = m_textureSlots.find(texture);
+                if (iter != m_textureSlots.end()) {
+                    slot = iter->second;
+                } else {
+                    // a free unit has never been used or has been released, so it is the least recently used one
+                    slot = static_cast<GLenum>(std::min_element(m_lastUse.begin(), m_lastUse.end()) - m_lastUse.begin());
+                    if (m_textures[slot]) {
+                        m_textureSlots.erase(m_textures[slot]);
+                    }
+                }
+                // texture functions operate on the active unit, so it has to be switched even if the texture is bound
+                activateSlot(slot);
+                if (m_textures[slot] != texture) {
+                    glCall(glBindTexture(GL_TEXTURE_2D, texture));
+                    m_textures[slot] = texture;
+                    m_textureSlots[texture] = slot;
+                    ++m_calls;
+                } else {
+                    ++m_skipped;
+                }
+                m_lastUse[slot] = ++m_clock;
+                return slot;
+            }
+
+            void State::unbindTexture(GLuint texture) {
+                auto iter = m_textureSlots.find(texture);
+                if (iter == m_textureSlots.end()) {
+                    return;
+                }
+                GLenum slot = iter->second;
+                activateSlot(slot);
+                glCall(glBindTexture(GL_TEXTURE_2D, 0));
+                ++m_calls;
+                m_textures[slot] = 0;
+                m_lastUse[slot] = 0;
+                m_textureSlots.erase(iter);
+            }
+
+            void State::setBlend(bool enabled, GLenum source, GLenum destination) {
+                GLuint blend = enabled ? 1 : 0;
+                if (blend != m_blend) {
+                    if (enabled) {
+                        glCall(glEnable(GL_BLEND));
+                    } else {
+                        glCall(glDisable(GL_BLEND));
+                    }
+                    m_blend = blend;
+                    ++m_calls;
+                } else {
+                    ++m_skipped;
+                }
+                if (!enabled) {
+                    return;
+                }
+                if (source != m_blendSource || destination != m_blendDestination) {
+                    glCall(glBlendFunc(source, destination));
+                    m_blendSource = source;
+                    m_blendDestination = destination;
+                    ++m_calls;
+                } else {
+                    ++m_skipped;
+                }
+            }
+
+            void State::forgetProgram(GLuint program) {
+                // a deleted program stays in use until another one is used, its name may be reused before that
+                if (program == m_program) {
+                    m_program = s_unknown;
+                }
+            }
+
+            void State::forgetVertexArray(GLuint vertexArray) {
+                m_elementBuffers.erase(vertexArray);
+                // deleting the bound vertex array binds 0
+                if (vertexArray == m_vertexArray) {
+                    m_vertexArray = 0;
+                }
+            }
+
+            void State::forgetBuffer(GLuint buffer) {
+                // deleting a buffer unbinds it from the targets, the indexed binding points and the bound vertex array,
+                // other vertex arrays keep referencing it but its name may be reused
+                for (auto& binding : m_buffers) {
+                    if (binding.second == buffer) {
+                        binding.second = 0;
+                    }
+                }
+                for (auto iter = m_elementBuffers.begin(); iter != m_elementBuffers.end();) {
+                    iter = iter->second == buffer ? m_elementBuffers.erase(iter) : std::next(iter);
+                }
+                for (auto& binding : m_indexedBuffers) {
+                    if (binding.second == buffer) {
+                        binding.second = 0;
+                    }
+                }
+            }
+
+            void State::forgetTexture(GLuint texture) {
+                // deleting a texture unbinds it from all units
+                if (auto iter = m_textureSlots.find(texture); iter != m_textureSlots.end()) {
+                    m_textures[iter->second] = 0;
+                    m_lastUse[iter->second] = 0;
+                    m_textureSlots.erase(iter);
+                }
+            }
+
+            void State::reset() {
+                m_program = s_unknown;
+                m_vertexArray = s_unknown;
+                m_elementBuffers.clear();
+                m_buffers.clear();
+                m_indexedBuffers.clear();
+                m_textures.clear();
+                m_lastUse.clear();
+                m_textureSlots.clear();
+                m_activeSlot = s_unknown;
+                m_clock = 0;
+                m_blend = s_unknown;
+                m_blendSource = GL_ONE;
+                m_blendDestination = GL_ZERO;
+            }
+
+            void State::resetCounters() {
+                m_calls = 0;
+                m_skipped = 0;
+                m_uploaded = 0;
+                m_draws = 0;
+                m_primitives = 0;
+            }
+
+            void State::activateSlot(GLenum slot) {
+                if (slot == m_activeSlot) {
+                    ++m_skipped;
+                    return;
+                }
+                glCall(glActiveTexture(GL_TEXTURE0 + slot));
+                m_activeSlot = slot;
+                ++m_calls;
+            }
+
+            std::string State::toString() const {
+                std::stringstream ss;
+                ss << "State(" << m_program << ',' << m_vertexArray << ',' << m_textureSlots.size() << ',' << m_calls << ',' << m_skipped << ')';
+                return ss.str();
+            }
+
+        }
+    }
+}
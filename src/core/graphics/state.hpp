@@ -0,0 +1,211 @@
+#ifndef _CORE_GRAPHICS_STATE_H
+#define _CORE_GRAPHICS_STATE_H
+/** @file */
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/graphics/common.hpp"
+#include "core/loggable.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            /**//**
+             * \brief Tracks the OpenGL binding state to skip redundant state changes.
+             *
+             * All Bindable implementations bind through the State, a bind of the object which is already bound
+             * does not reach OpenGL. Keeps track of the current program, vertex array, buffers per target,
+             * indexed buffer bindings, texture units and blending. The element array binding is part of the vertex array and is tracked per vertex array.
+             * Texture units are handed out least recently used first, bounded by GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS.
+             * Code changing the state directly has to restore it or call reset().
+             */
+            class State final : public Loggable {
+                // binding of which the value is not known, the next bind always reaches OpenGL
+                static constexpr GLuint s_unknown = static_cast<GLuint>(-1);
+
+                GLuint m_program;
+                GLuint m_vertexArray;
+                // element array buffer per vertex array
+                std::unordered_map<GLuint, GLuint> m_elementBuffers;
+                // buffer per target other than the element array
+                std::unordered_map<GLenum, GLuint> m_buffers;
+                // buffer per indexed binding point of a target
+                std::map<std::pair<GLenum, GLuint>, GLuint> m_indexedBuffers;
+                // texture bound per unit, 0 if the unit is free
+                std::vector<GLuint> m_textures;
+                // value of m_clock when the unit has been used last
+                std::vector<uint64_t> m_lastUse;
+                std::unordered_map<GLuint, GLenum> m_textureSlots;
+                GLenum m_activeSlot;
+                uint64_t m_clock;
+                // 0 disabled, 1 enabled, s_unknown unknown
+                GLuint m_blend;
+                GLenum m_blendSource, m_blendDestination;
+                size_t m_calls;
+                size_t m_skipped;
+                size_t m_uploaded;
+                size_t m_draws;
+                size_t m_primitives;
+
+                public:
+                /**//**
+                 * \brief Construct State with every binding unknown.
+                 */
+                State();
+                ~State();
+
+                /**//**
+                 * \brief Get the State of the current context.
+                 *
+                 * @return reference to the shared State
+                 */
+                static State& global();
+
+                /**//**
+                 * \brief Make a program current.
+                 *
+                 * @param program OpenGL name of the program, 0 for none
+                 */
+                void useProgram(GLuint program);
+                /**//**
+                 * \brief Bind a vertex array.
+                 *
+                 * @param vertexArray OpenGL name of the vertex array, 0 for none
+                 */
+                void bindVertexArray(GLuint vertexArray);
+                /**//**
+                 * \brief Bind a buffer to a target.
+                 *
+                 * @param target buffer binding target, GL_ELEMENT_ARRAY_BUFFER binds to the current vertex array
+                 * @param buffer OpenGL name of the buffer, 0 for none
+                 */
+                void bindBuffer(GLenum target, GLuint buffer);
+                /**//**
+                 * \brief Bind a buffer to an indexed binding point of a target.
+                 *
+                 * Binds the buffer to the target itself as well, like glBindBufferBase does.
+                 *
+                 * @param target indexed buffer target, e.g. GL_UNIFORM_BUFFER
+                 * @param index binding point of the target
+                 * @param buffer OpenGL name of the buffer, 0 for none
+                 */
+                void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+                /**//**
+                 * \brief Bind a texture to a unit and make the unit active.
+                 *
+                 * Keeps the unit the texture is bound to if any, otherwise evicts the least recently used unit.
+                 *
+                 * @param texture OpenGL name of the texture
+                 *
+                 * @return unit the texture is bound to, counted from GL_TEXTURE0
+                 */
+                GLenum bindTexture(GLuint texture);
+                /**//**
+                 * \brief Unbind a texture from its unit, freeing the unit.
+                 *
+                 * @param texture OpenGL name of the texture
+                 */
+                void unbindTexture(GLuint texture);
+                /**//**
+                 * \brief Set blending.
+                 *
+                 * @param enabled true to enable blending
+                 * @param source source factor, ignored if disabled
+                 * @param destination destination factor, ignored if disabled
+                 */
+                void setBlend(bool enabled, GLenum source = GL_SRC_ALPHA, GLenum destination = GL_ONE_MINUS_SRC_ALPHA);
+
+                /**//**
+                 * \brief Forget a deleted program.
+                 *
+                 * @param program OpenGL name of the deleted program
+                 */
+                void forgetProgram(GLuint program);
+                /**//**
+                 * \brief Forget a deleted vertex array.
+                 *
+                 * @param vertexArray OpenGL name of the deleted vertex array
+                 */
+                void forgetVertexArray(GLuint vertexArray);
+                /**//**
+                 * \brief Forget a deleted buffer.
+                 *
+                 * @param buffer OpenGL name of the deleted buffer
+                 */
+                void forgetBuffer(GLuint buffer);
+                /**//**
+                 * \brief Forget a deleted texture.
+                 *
+                 * @param texture OpenGL name of the deleted texture
+                 */
+                void forgetTexture(GLuint texture);
+
+                /**//**
+                 * \brief Mark every binding as unknown.
+                 *
+                 * Has to be called when a new OpenGL context is made current.
+                 */
+                void reset();
+
+                /**//**
+                 * \brief Get number of state changes which reached OpenGL.
+                 *
+                 * @return number of issued OpenGL calls since the last resetCounters()
+                 */
+                inline size_t getCallCount() const { return m_calls; }
+                /**//**
+                 * \brief Get number of redundant state changes which have been skipped.
+                 *
+                 * @return number of skipped OpenGL calls since the last resetCounters()
+                 */
+                inline size_t getSkipCount() const { return m_skipped; }
+                /**//**
+                 * \brief Record data copied into a buffer.
+                 *
+                 * @param bytes size of the upload
+                 */
+                inline void countUpload(GLsizeiptr bytes) { m_uploaded += static_cast<size_t>(bytes); }
+                /**//**
+                 * \brief Get amount of data uploaded to buffers.
+                 *
+                 * @return number of bytes passed to OpenGL since the last resetCounters()
+                 */
+                inline size_t getUploadedBytes() const { return m_uploaded; }
+                /**//**
+                 * \brief Record a draw call.
+                 *
+                 * @param primitives number of triangles drawn by the call
+                 */
+                inline void countDraw(size_t primitives) { ++m_draws; m_primitives += primitives; }
+                /**//**
+                 * \brief Get number of draw calls.
+                 *
+                 * @return number of draw calls since the last resetCounters()
+                 */
+                inline size_t getDrawCount() const { return m_draws; }
+                /**//**
+                 * \brief Get number of drawn triangles.
+                 *
+                 * @return number of triangles drawn since the last resetCounters()
+                 */
+                inline size_t getPrimitiveCount() const { return m_primitives; }
+                /**//**
+                 * \brief Reset the call, upload and draw counters.
+                 */
+                void resetCounters();
+
+                std::string toString() const override;
+
+                private:
+                void activateSlot(GLenum slot);
+            };
+
+        }
+    }
+}
+
+#endif
@@ -1,77 +1,135 @@
 /** @file */
 #include "core/graphics/texture.hpp"
 #include <sstream>
-#include "stb/stb_image.h"
 #include "core/exceptions/input.hpp"
+#include "core/graphics/cache.hpp"
+#include "core/graphics/state.hpp"
 
 namespace tme {
     namespace  core {
         namespace graphics {
 
-            Texture::SlotGenerator Texture::s_slotGenerator = Texture::SlotGenerator();
+            Texture::Texture(const std::string& filePath) : Texture(filePath, defaultOptions()) {}
 
-            Texture::SlotGenerator::SlotGenerator() : m_nextSlot(0), m_freeSlots() {}
-            Texture::SlotGenerator::~SlotGenerator() {}
-
-            GLenum Texture::SlotGenerator::get() {
-                if (m_freeSlots.size() > 0) {
-                    GLenum back = m_freeSlots.back();
-                    m_freeSlots.pop_back();
-                    return back;
-                }
-                return m_nextSlot++;
-            }
-
-            void Texture::SlotGenerator::release(GLenum slot) {
-                m_freeSlots.push_back(slot);
-            }
-
-            Texture::Texture(const std::string& filePath)
-                : m_slot(s_slotGenerator.get()),
+            Texture::Texture(const std::string& filePath, const Options& options)
+                : m_slot(0),
                 m_filePath(filePath),
                 m_width(0),
                 m_height(0),
-                m_channels(0) {
-                stbi_set_flip_vertically_on_load(1);
-                unsigned char* localBuffer = stbi_load(m_filePath.c_str(), &m_width, &m_height, &m_channels, 4);
-                if (!localBuffer) {
+                m_channels(0),
+                m_options(options),
+                m_pending(false),
+                m_uniqueId(uuid<Texture>()) {
+                Image image = TextureCache::global().load(m_filePath);
+                if (!image.getPixels()) {
                     TME_ERROR("could not read image file {}", m_filePath);
                     throw exceptions::InvalidInput("could not read image file");
                 }
+                m_width = image.getWidth();
+                m_height = image.getHeight();
+                m_channels = 4;
+
+                create(image.getPixels());
+                TME_INFO("created {}", *this);
+            }
+
+            Texture::Texture(Dimension width, Dimension height) : Texture(width, height, defaultOptions()) {}
+
+            Texture::Texture(Dimension width, Dimension height, const Options& options)
+                : m_slot(0),
+                m_filePath(),
+                m_width(width),
+                m_height(height),
+                m_channels(4),
+                m_options(options),
+                m_pending(false),
+                m_uniqueId(uuid<Texture>()) {
+                // the content is set later, clearing it on the host would only cost an upload
+                create(nullptr);
+                TME_INFO("created {}", *this);
+            }
+
+            Texture::Texture(const std::string& filePath, Dimension width, Dimension height, const unsigned char* pixels, const Options& options)
+                : m_slot(0),
+                m_filePath(filePath),
+                m_width(width),
+                m_height(height),
+                m_channels(4),
+                m_options(options),
+                m_pending(true),
+                m_uniqueId(uuid<Texture>()) {
+                create(pixels);
+                TME_INFO("created {}", *this);
+            }
 
+            void Texture::create(const unsigned char* pixels) {
                 glCall(glGenTextures(1, &m_renderingId));
                 bind();
 
-                glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+                // minified tiles blend between the two closest levels, magnified ones stay pixelated
+                GLint minFilter = m_options.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST;
+                glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
                 glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
                 glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
                 glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-                
-                glCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA4, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, localBuffer));
+                // single channel formats would otherwise be sampled as opaque red
+                if (m_options.format == R8 || m_options.format == CompressedR) {
+                    const GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+                    glCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+                }
 
-                stbi_image_free(localBuffer);
-                TME_INFO("created {}", *this);
+                upload(pixels);
+            }
+
+            void Texture::upload(const unsigned char* pixels) {
+                glCall(glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(m_options.format), m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+                if (m_options.mipmaps) {
+                    glCall(glGenerateMipmap(GL_TEXTURE_2D));
+                }
             }
 
             Texture::~Texture() {
                 TME_INFO("deleting {}", *this);
                 unbind();
                 glCall(glDeleteTextures(1, &m_renderingId));
-                s_slotGenerator.release(m_slot);
+                State::global().forgetTexture(m_renderingId);
             }
 
             void Texture::bind() const {
-                glCall(glActiveTexture(GL_TEXTURE0 + m_slot));
-                glCall(glBindTexture(GL_TEXTURE_2D, m_renderingId));
+                m_slot = State::global().bindTexture(m_renderingId);
             }
 
             void Texture::unbind() const {
-                glCall(glBindTexture(GL_TEXTURE_2D, 0));
+                State::global().unbindTexture(m_renderingId);
+            }
+
+            std::vector<unsigned char> Texture::getPixels() const {
+                std::vector<unsigned char> pixels(static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * 4);
+                bind();
+                glCall(glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+                return pixels;
+            }
+
+            void Texture::setPixels(Dimension x, Dimension y, Dimension width, Dimension height, const unsigned char* pixels) {
+                TME_ASSERT(x >= 0 && y >= 0 && x + width <= m_width && y + height <= m_height, "pixels outside of the texture");
+                bind();
+                glCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+                if (m_options.mipmaps) {
+                    glCall(glGenerateMipmap(GL_TEXTURE_2D));
+                }
+            }
+
+            void Texture::load(Dimension width, Dimension height, const unsigned char* pixels) {
+                m_width = width;
+                m_height = height;
+                m_pending = false;
+                bind();
+                upload(pixels);
             }
 
             std::string Texture::toString() const {
                 std::stringstream ss;
-                ss << "Texture(" << m_slot << ',' << m_width << ',' << m_height << ',' << m_filePath << ')';
+                ss << "Texture(" << m_slot << ',' << m_width << ',' << m_height << ',' << m_filePath << ',' << std::hex << std::showbase << m_options.format << ')';
                 return ss.str();
             }
 
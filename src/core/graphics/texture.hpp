@@ -16,30 +16,50 @@ namespace tme {
             /**//**
              * \brief Abstraction to load an image from disk into an OpenGL texture.
              *
-             * Can be set active on any available texture slot.
+             * Textures are bound to the texture units least recently used first by the State,
+             * binding a texture which is still bound to a unit is free.
              */
             class Texture final : public Loggable, public Bindable {
-                class SlotGenerator {
-                    GLenum m_nextSlot;
-                    std::vector<GLenum> m_freeSlots;
-                    public:
-                    SlotGenerator();
-                    ~SlotGenerator();
-
-                    GLenum get();
-                    void release(GLenum slot);
-                };
-                static SlotGenerator s_slotGenerator;
 
                 public:
                 ///  type alias used for the dimensions of the image
                 using Dimension = int;
 
+                /**//**
+                 * \brief Internal formats a texture can be stored in.
+                 *
+                 * Images are always provided as RGBA with 8 bits per channel, the driver converts them.
+                 * Single channel formats keep the red channel and are sampled as opaque gray,
+                 * compressed formats are compressed by the driver on upload.
+                 */
+                enum Format : GLenum {
+                    RGBA4 = GL_RGBA4,
+                    RGBA8 = GL_RGBA8,
+                    SRGBA8 = GL_SRGB8_ALPHA8,
+                    R8 = GL_R8,
+                    CompressedRGBA = GL_COMPRESSED_RGBA,
+                    /// block compressed single channel (BC4)
+                    CompressedR = GL_COMPRESSED_RED_RGTC1
+                };
+
+                /**//**
+                 * \brief Storage options of a texture.
+                 */
+                struct Options {
+                    /// internal format of the texture
+                    Format format;
+                    /// generate mipmaps, used while the texture is drawn smaller than its size, e.g. when zoomed out
+                    bool mipmaps;
+                };
+
                 private:
-                GLenum m_slot;
+                mutable GLenum m_slot;
                 std::string m_filePath;
                 Dimension m_width, m_height;
                 int m_channels;
+                Options m_options;
+                bool m_pending;
+                Identifier m_uniqueId;
 
                 public:
                 /**//**
@@ -48,15 +68,53 @@ namespace tme {
                  * @param filePath path to texture file
                  */
                 Texture(const std::string& filePath);
+                /**//**
+                 * \brief Load image from filePath and create texture with the given storage options.
+                 *
+                 * @param filePath path to texture file
+                 * @param options format and mipmapping of the texture
+                 */
+                Texture(const std::string& filePath, const Options& options);
+                /**//**
+                 * \brief Create texture without content.
+                 *
+                 * The pixels are undefined until they are set with setPixels().
+                 *
+                 * @param width width of the texture in pixels
+                 * @param height height of the texture in pixels
+                 */
+                Texture(Dimension width, Dimension height);
+                /**//**
+                 * \brief Create texture without content with the given storage options.
+                 *
+                 * @param width width of the texture in pixels
+                 * @param height height of the texture in pixels
+                 * @param options format and mipmapping of the texture
+                 */
+                Texture(Dimension width, Dimension height, const Options& options);
+                /**//**
+                 * \brief Create placeholder texture for an image which is loaded later.
+                 *
+                 * The texture stays pending until its content is replaced with load().
+                 *
+                 * @param filePath path to the image file which will be loaded
+                 * @param width width of the placeholder in pixels
+                 * @param height height of the placeholder in pixels
+                 * @param pixels RGBA pixels of the placeholder with 8 bits per channel
+                 * @param options format and mipmapping of the loaded texture
+                 */
+                Texture(const std::string& filePath, Dimension width, Dimension height, const unsigned char* pixels, const Options& options);
                 ~Texture();
 
                 void bind() const override;
                 void unbind() const override;
 
                 /**//**
-                 * \brief Get unique slot for texture to be active on.
+                 * \brief Get the slot the texture has been bound to.
+                 *
+                 * Only valid after bind(), binding other textures may evict the texture from its slot.
                  *
-                 * @return unique slot for the texture
+                 * @return slot of the texture
                  */
                 inline GLenum getSlot() const { return m_slot; }
 
@@ -80,7 +138,71 @@ namespace tme {
                  */
                 std::string getFilePath() const { return m_filePath; }
 
+                /**//**
+                 * \brief Check if the texture still shows a placeholder.
+                 *
+                 * @return true if the image of the texture has not been loaded yet
+                 */
+                inline bool isPending() const { return m_pending; }
+
+                /**//**
+                 * \brief Get an id which is not reused after the texture is deleted.
+                 *
+                 * GL reuses the names of deleted textures, so getId() may identify a different texture later.
+                 *
+                 * @return id unique to this texture for the lifetime of the application
+                 */
+                inline Identifier getUniqueId() const { return m_uniqueId; }
+
+                /**//**
+                 * \brief Get storage options.
+                 *
+                 * @return format and mipmapping of the texture
+                 */
+                inline const Options& getOptions() const { return m_options; }
+
+                /**//**
+                 * \brief Get the options textures are created with if none are given.
+                 *
+                 * @return RGBA8 without mipmaps
+                 */
+                static constexpr Options defaultOptions() { return {RGBA8, false}; }
+
+                /**//**
+                 * \brief Read back the content of the texture.
+                 *
+                 * @return RGBA pixels with 8 bits per channel in rows starting at the bottom
+                 */
+                std::vector<unsigned char> getPixels() const;
+                /**//**
+                 * \brief Replace a rectangle of the texture.
+                 *
+                 * Not supported for compressed formats. Mipmaps are regenerated.
+                 *
+                 * @param x first pixel of the rectangle in x direction
+                 * @param y first pixel of the rectangle in y direction, counted from the bottom
+                 * @param width width of the rectangle in pixels
+                 * @param height height of the rectangle in pixels
+                 * @param pixels RGBA pixels with 8 bits per channel in rows starting at the bottom
+                 */
+                void setPixels(Dimension x, Dimension y, Dimension width, Dimension height, const unsigned char* pixels);
+                /**//**
+                 * \brief Replace the whole content of the texture, changing its size.
+                 *
+                 * The id and slot of the texture are kept, so users of a pending texture see the image once it is loaded.
+                 * If a buffer is bound to GL_PIXEL_UNPACK_BUFFER, pixels is an offset into that buffer.
+                 *
+                 * @param width new width of the texture in pixels
+                 * @param height new height of the texture in pixels
+                 * @param pixels RGBA pixels with 8 bits per channel in rows starting at the bottom
+                 */
+                void load(Dimension width, Dimension height, const unsigned char* pixels);
+
                 std::string toString() const override;
+
+                private:
+                void create(const unsigned char* pixels);
+                void upload(const unsigned char* pixels);
             };
 
         }
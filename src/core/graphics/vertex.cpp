@@ -2,6 +2,7 @@
 #include "core/graphics/vertex.hpp"
 #include <sstream>
 #include "core/storage.hpp"
+#include "core/graphics/state.hpp"
 
 namespace tme {
     namespace  core {
@@ -49,7 +50,7 @@ namespace tme {
             }
 
 
-            VertexBuffer::VertexBuffer(GLsizeiptr entrySize, GLsizeiptr size) : Buffer(GL_ARRAY_BUFFER, entrySize, size) {
+            VertexBuffer::VertexBuffer(GLsizeiptr entrySize, GLsizeiptr size, bool streaming, bool clearOnRemove) : Buffer(GL_ARRAY_BUFFER, entrySize, size, streaming, clearOnRemove) {
                 TME_INFO("created {}", *this);
             }
             VertexBuffer::~VertexBuffer() {
@@ -63,8 +64,8 @@ namespace tme {
             }
 
 
-            VertexArray::VertexArray(Handle<VertexBuffer> vertexBuffer, Handle<VertexLayout> vertexLayout)
-            : m_vertexBuffer(vertexBuffer), m_vertexLayout(vertexLayout) {
+            VertexArray::VertexArray(Handle<VertexBuffer> vertexBuffer, Handle<VertexLayout> vertexLayout, GLuint divisor)
+            : m_vertexBuffer(vertexBuffer), m_vertexLayout(vertexLayout), m_divisor(divisor) {
                 glCall(glGenVertexArrays(1, &m_renderingId));
                 bind();
                 vertexBuffer->bind();
@@ -74,6 +75,9 @@ namespace tme {
                     const auto& element = elements[i];
                     glCall(glEnableVertexAttribArray(i));
                     glCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, vertexLayout->getStride(), (const GLvoid*) offset));
+                    if (divisor > 0) {
+                        glCall(glVertexAttribDivisor(i, divisor));
+                    }
                     offset += element.count * element.typeSize;
                 }
                 TME_INFO("created {}", *this);
@@ -83,20 +87,22 @@ namespace tme {
                 TME_INFO("deleting {}", *this);
                 unbind();
                 glCall(glDeleteVertexArrays(1, &m_renderingId));
+                State::global().forgetVertexArray(m_renderingId);
             }
 
             void VertexArray::bind() const {
-                glCall(glBindVertexArray(m_renderingId));
+                State::global().bindVertexArray(m_renderingId);
             }
             void VertexArray::unbind() const {
-                glCall(glBindVertexArray(0));
+                State::global().bindVertexArray(0);
             }
 
             std::string VertexArray::toString() const {
                 std::stringstream ss;
                 ss << "VertexArray(" << getId() << ',';
                 ss << m_vertexBuffer->toString() << ',';
-                ss << m_vertexLayout->toString() << ')';
+                ss << m_vertexLayout->toString() << ',';
+                ss << m_divisor << ')';
                 return ss.str();
             }
 
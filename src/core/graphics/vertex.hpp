@@ -94,11 +94,15 @@ namespace tme {
                  * \brief Construct Buffer instance.
                  *
                  * Uses GL_ARRAY_BUFFER for the type.
+                 * Removed vertices are not cleared by default because removing the corresponding indices
+                 * already prevents them from being rendered. Per instance data has no indices and should be cleared.
                  *
                  * @param entrySize size of a single vertex entry in bytes
                  * @param size amount of vertices the buffer should be able to store
+                 * @param streaming true if updates should be collected until Buffer::flush() is called
+                 * @param clearOnRemove true if removed vertices should be overwritten with zeros
                  */
-                VertexBuffer(GLsizeiptr entrySize, GLsizeiptr size);
+                VertexBuffer(GLsizeiptr entrySize, GLsizeiptr size, bool streaming = false, bool clearOnRemove = false);
                 ~VertexBuffer();
 
                 std::string toString() const override;
@@ -106,18 +110,22 @@ namespace tme {
 
             /**//**
              * \brief Combination of a VertexBuffer and its corresponding VertexLayout.
+             *
+             * The attributes either advance per vertex or, with a divisor > 0, per rendered instance.
              */
             class VertexArray final : public Loggable, public Bindable {
                 Handle<VertexBuffer> m_vertexBuffer;
                 Handle<VertexLayout> m_vertexLayout;
+                GLuint m_divisor;
                 public:
                 /**//**
                  * \brief Construct VertexArray instance.
                  *
                  * @param vertexBuffer VertexBuffer to use
                  * @param vertexLayout VertexLayout to use
+                 * @param divisor number of instances rendered before the attributes advance, 0 to advance per vertex
                  */
-                VertexArray(Handle<VertexBuffer> vertexBuffer, Handle<VertexLayout> vertexLayout);
+                VertexArray(Handle<VertexBuffer> vertexBuffer, Handle<VertexLayout> vertexLayout, GLuint divisor = 0);
                 ~VertexArray();
 
                 void bind() const override;
@@ -135,6 +143,12 @@ namespace tme {
                  * @return Handle to the used VertexLayout
                  */
                 inline Handle<VertexLayout> getVertexLayout() const { return m_vertexLayout; }
+                /**//**
+                 * \brief Get attribute divisor.
+                 *
+                 * @return number of instances rendered before the attributes advance, 0 if they advance per vertex
+                 */
+                inline GLuint getDivisor() const { return m_divisor; }
 
                 std::string toString() const override;
             };
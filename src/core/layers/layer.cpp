@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <sstream>
 #include "core/exceptions/input.hpp"
+#include "core/graphics/profiler.hpp"
 
 namespace tme {
     namespace core {
@@ -22,6 +23,7 @@ namespace tme {
 
             void Stack::render() {
                 for (auto it = m_layers.cbegin(); it != m_layers.cend(); ++it) {
+                    graphics::Profiler::Scope scope(**it);
                     (*it)->render();
                 }
             }
@@ -69,10 +69,15 @@ namespace tme {
                  * \brief Construct a new Layer of type T in-place on the top of the Stack.
                  *
                  * @param args arguments forwarded to the constructor of T
+                 *
+                 * @return reference to the new Layer, valid until it is popped
                  */
                 template<typename T, typename... Args>
-                void push(Args... args) {
-                    m_layers.push_back(std::make_unique<T>(args...));
+                T& push(Args... args) {
+                    auto layer = std::make_unique<T>(args...);
+                    T& reference = *layer;
+                    m_layers.push_back(std::move(layer));
+                    return reference;
                 }
 
                 /**//**
@@ -0,0 +1,123 @@
+/** @file */
+#include "core/layers/profiler.hpp"
+#include <cfloat>
+#include "core/key.hpp"
+
+#include "imgui.h"
+
+namespace tme {
+    namespace core {
+        namespace layers {
+
+            ProfilerOverlay::ProfilerOverlay()
+                : Layer("ProfilerOverlay"),
+                Dispatcher(this),
+                m_visible(graphics::Profiler::global().isEnabled()),
+                m_selectedDepth(0),
+                m_selected() {}
+
+            ProfilerOverlay::~ProfilerOverlay() {}
+
+            void ProfilerOverlay::onEvent(events::Event& event) {
+                dispatchEvent<events::KeyPress>(event, &ProfilerOverlay::handleKeyPress);
+            }
+
+            bool ProfilerOverlay::handleKeyPress(events::KeyPress& event) {
+                if (event.getKey().getKeyCode() != TME_KEY_F3) {
+                    return false;
+                }
+                setVisible(!m_visible);
+                return true;
+            }
+
+            void ProfilerOverlay::setVisible(bool visible) {
+                m_visible = visible;
+                graphics::Profiler::global().setEnabled(visible);
+            }
+
+            // GCOVR_EXCL_START
+            void ProfilerOverlay::render() {
+                if (!m_visible) {
+                    return;
+                }
+                ImGui::SetNextWindowSize(ImVec2(700, 500), ImGuiCond_FirstUseEver);
+                bool open = true;
+                ImGui::Begin("Profiler", &open);
+
+                const auto& sections = graphics::Profiler::global().getSections();
+                if (sections.empty()) {
+                    ImGui::Text("Waiting for the first frames...");
+                } else {
+                    // the frame contains all other sections
+                    showHistory(*sections.front());
+                    for (const auto* section : sections) {
+                        if (section->depth == m_selectedDepth && section->name == m_selected && section != sections.front()) {
+                            showHistory(*section);
+                        }
+                    }
+                    ImGui::Separator();
+
+                    ImGui::Columns(7, "sections");
+                    ImGui::Text("Section");
+                    ImGui::NextColumn();
+                    ImGui::Text("GPU ms");
+                    ImGui::NextColumn();
+                    ImGui::Text("CPU ms");
+                    ImGui::NextColumn();
+                    ImGui::Text("Draws");
+                    ImGui::NextColumn();
+                    ImGui::Text("Triangles");
+                    ImGui::NextColumn();
+                    ImGui::Text("State changes");
+                    ImGui::NextColumn();
+                    ImGui::Text("Uploaded KB");
+                    ImGui::NextColumn();
+                    ImGui::Separator();
+                    for (const auto* section : sections) {
+                        const auto& statistics = section->statistics;
+                        // names are only unique per depth
+                        ImGui::PushID(section);
+                        // nesting is shown by indenting the name
+                        std::string label = std::string(section->depth * 2, ' ') + section->name;
+                        bool selected = section->depth == m_selectedDepth && section->name == m_selected;
+                        if (ImGui::Selectable(label.c_str(), selected, ImGuiSelectableFlags_SpanAllColumns)) {
+                            m_selectedDepth = section->depth;
+                            m_selected = section->name;
+                        }
+                        ImGui::NextColumn();
+                        ImGui::Text("%.3f", statistics.gpuTime);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.3f", statistics.cpuTime);
+                        ImGui::NextColumn();
+                        ImGui::Text("%zu", statistics.drawCalls);
+                        ImGui::NextColumn();
+                        ImGui::Text("%zu", statistics.primitives);
+                        ImGui::NextColumn();
+                        ImGui::Text("%zu", statistics.stateChanges);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(statistics.uploadedBytes) / 1024.0);
+                        ImGui::NextColumn();
+                        ImGui::PopID();
+                    }
+                    ImGui::Columns(1);
+                }
+
+                ImGui::End();
+                if (!open) {
+                    setVisible(false);
+                }
+            }
+
+            void ProfilerOverlay::showHistory(const graphics::Profiler::Section& section) {
+                std::string gpuLabel = section.name + " GPU";
+                std::string cpuLabel = section.name + " CPU";
+                ImGui::PlotHistogram(gpuLabel.c_str(), section.gpuHistory.data(), static_cast<int>(section.gpuHistory.size()),
+                        static_cast<int>(section.historyOffset), nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+                ImGui::PlotHistogram(cpuLabel.c_str(), section.cpuHistory.data(), static_cast<int>(section.cpuHistory.size()),
+                        static_cast<int>(section.historyOffset), nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+            }
+            // GCOVR_EXCL_STOP
+
+        }
+    }
+}
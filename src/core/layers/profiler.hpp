@@ -0,0 +1,51 @@
+#ifndef _CORE_LAYERS_PROFILER_H
+#define _CORE_LAYERS_PROFILER_H
+/** @file */
+
+#include <string>
+#include "core/events/dispatcher.hpp"
+#include "core/events/event.hpp"
+#include "core/events/key.hpp"
+#include "core/graphics/profiler.hpp"
+#include "core/layers/layer.hpp"
+
+namespace tme {
+    namespace core {
+        namespace layers {
+
+            /**//**
+             * \brief Shows the measurements of the global graphics::Profiler.
+             *
+             * Lists the GPU and CPU time, draw calls, triangles, state changes and uploaded bytes of every section of the last
+             * resolved frame, nested like the sections, along with rolling histograms of the frame and the selected section.
+             * F3 toggles the overlay, the profiler only records frames while it is shown.
+             * Has to be pushed below the Imgui layer, which renders the ImGui frame.
+             */
+            class ProfilerOverlay final : public Layer, public events::Dispatcher<ProfilerOverlay> {
+                bool m_visible;
+                // depth and name of the section whose history is shown below the one of the frame
+                size_t m_selectedDepth;
+                std::string m_selected;
+
+                public:
+                /**//**
+                 * \brief Construct overlay, visible if the Profiler is enabled.
+                 */
+                ProfilerOverlay();
+                ~ProfilerOverlay();
+
+                void onEvent(events::Event& event) override;
+
+                void render() override;
+
+                private:
+                bool handleKeyPress(events::KeyPress& event);
+                void showHistory(const graphics::Profiler::Section& section);
+                void setVisible(bool visible);
+            };
+
+        }
+    }
+}
+
+#endif
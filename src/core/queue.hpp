@@ -0,0 +1,96 @@
+#ifndef _CORE_QUEUE_H
+#define _CORE_QUEUE_H
+/** @file */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace tme {
+    namespace core {
+
+        /**//**
+         * \brief Bounded lock-free queue for exactly one producer and one consumer thread.
+         *
+         * The elements are stored in a ring buffer. The producer only writes the tail and
+         * the consumer only writes the head, so both sides get along without locks.
+         * One slot always stays unused to tell a full from an empty queue.
+         */
+        template<typename T>
+        class SpscQueue {
+            std::unique_ptr<T[]> m_data;
+            size_t m_capacity;
+            // the indices are written by different threads, keep them on separate cache lines
+            alignas(64) std::atomic<size_t> m_head;
+            alignas(64) std::atomic<size_t> m_tail;
+
+            public:
+            /**//**
+             * \brief Construct empty SpscQueue.
+             *
+             * @param capacity maximum number of elements in the queue
+             */
+            explicit SpscQueue(size_t capacity) : m_data(new T[capacity + 1]), m_capacity(capacity + 1), m_head(0), m_tail(0) {}
+
+            SpscQueue(const SpscQueue&) = delete;
+            SpscQueue& operator=(const SpscQueue&) = delete;
+
+            /**//**
+             * \brief Append an element, may only be called by the producer.
+             *
+             * @param value the element to be moved into the queue, left untouched if the queue is full
+             *
+             * @return true if the element has been added, false if the queue is full
+             */
+            bool push(T& value) {
+                size_t tail = m_tail.load(std::memory_order_relaxed);
+                size_t next = (tail + 1) % m_capacity;
+                if (next == m_head.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                m_data[tail] = std::move(value);
+                m_tail.store(next, std::memory_order_release);
+                return true;
+            }
+
+            /**//**
+             * \brief Remove the oldest element, may only be called by the consumer.
+             *
+             * @param value receives the element
+             *
+             * @return true if an element has been removed, false if the queue is empty
+             */
+            bool pop(T& value) {
+                size_t head = m_head.load(std::memory_order_relaxed);
+                if (head == m_tail.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                value = std::move(m_data[head]);
+                m_head.store((head + 1) % m_capacity, std::memory_order_release);
+                return true;
+            }
+
+            /**//**
+             * \brief Check if the queue is empty.
+             *
+             * Only a snapshot, the other thread may change it right after.
+             *
+             * @return true if the queue contains no elements
+             */
+            bool empty() const {
+                return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+            }
+
+            /**//**
+             * \brief Get maximum number of elements.
+             *
+             * @return capacity of the queue
+             */
+            inline size_t getCapacity() const { return m_capacity - 1; }
+        };
+
+    }
+}
+
+#endif
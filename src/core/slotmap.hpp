@@ -0,0 +1,264 @@
+#ifndef _CORE_SLOTMAP_H
+#define _CORE_SLOTMAP_H
+/** @file */
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace tme {
+    namespace core {
+
+        /**//**
+         * \brief Storage container keeping its elements in one contiguous array.
+         *
+         * Elements are addressed by a Key made of a slot index and a generation. The slot stores the position of the
+         * element in the dense array and is reused after the element has been erased, its generation is increased then,
+         * so keys of erased elements are detected instead of reaching the element which took their slot.
+         * Insertion, erasure and lookup take constant time. Erasing moves the last element into the gap, so the order
+         * of the elements changes and pointers or iterators to them are invalidated, unlike the keys.
+         * Preferable to Storage for objects which are looked up and iterated every frame.
+         */
+        template<typename T>
+        class SlotMap {
+            public:
+            /**//**
+             * \brief Stable reference to an element of a SlotMap.
+             *
+             * A default constructed Key never refers to an element.
+             */
+            struct Key {
+                /// index of the slot
+                uint32_t index = 0;
+                /// generation of the slot when the element has been inserted
+                uint32_t generation = 0;
+
+                bool operator==(const Key& other) const { return index == other.index && generation == other.generation; }
+                bool operator!=(const Key& other) const { return !(*this == other); }
+            };
+
+            private:
+            static constexpr uint32_t s_noSlot = std::numeric_limits<uint32_t>::max();
+
+            struct Slot {
+                // position of the element in the dense array, or the next free slot while the slot is unused
+                uint32_t index;
+                // odd while the slot is used, so keys of unused slots and default keys never match
+                uint32_t generation;
+            };
+
+            std::vector<T> m_values;
+            // slot of every element of the dense array
+            std::vector<uint32_t> m_owners;
+            std::vector<Slot> m_slots;
+            uint32_t m_freeSlot;
+
+            public:
+            /**//**
+             * \brief Create empty slot map.
+             */
+            SlotMap() : m_values(), m_owners(), m_slots(), m_freeSlot(s_noSlot) {}
+
+            /**//**
+             * \brief Construct an element inside the slot map.
+             *
+             * @param args arguments used for construction of the element
+             *
+             * @return Key of the created element
+             */
+            template<typename ...Args>
+            Key emplace(Args&&... args) {
+                // the slot and owner are added first and removed again if the element can not be constructed,
+                // so no element is left without a slot
+                bool newSlot = m_freeSlot == s_noSlot;
+                uint32_t slot = newSlot ? static_cast<uint32_t>(m_slots.size()) : m_freeSlot;
+                if (newSlot) {
+                    m_slots.push_back({s_noSlot, 0});
+                }
+                try {
+                    m_owners.push_back(slot);
+                    m_values.emplace_back(std::forward<Args>(args)...);
+                } catch(...) {
+                    if (m_owners.size() > m_values.size()) {
+                        m_owners.pop_back();
+                    }
+                    if (newSlot) {
+                        m_slots.pop_back();
+                    }
+                    throw;
+                }
+                Slot& entry = m_slots[slot];
+                if (!newSlot) {
+                    m_freeSlot = entry.index;
+                }
+                entry.index = static_cast<uint32_t>(m_values.size() - 1);
+                ++entry.generation;
+                return {slot, entry.generation};
+            }
+
+            /**//**
+             * \brief Insert an element into the slot map.
+             *
+             * @param value element to be moved into the slot map
+             *
+             * @return Key of the inserted element
+             */
+            Key insert(T value) {
+                return emplace(std::move(value));
+            }
+
+            /**//**
+             * \brief Remove the element of a key.
+             *
+             * The last element takes the position of the removed one.
+             *
+             * @param key Key of the element to be removed
+             *
+             * @return true if an element has been removed, false if the key is stale
+             */
+            bool erase(Key key) {
+                if (!has(key)) {
+                    return false;
+                }
+                Slot& entry = m_slots[key.index];
+                uint32_t position = entry.index;
+                uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+                if (position != last) {
+                    m_values[position] = std::move(m_values[last]);
+                    m_owners[position] = m_owners[last];
+                    m_slots[m_owners[position]].index = position;
+                }
+                m_values.pop_back();
+                m_owners.pop_back();
+                release(key.index);
+                return true;
+            }
+
+            /**//**
+             * \brief Get the element of a key.
+             *
+             * @param key Key of the element to be accessed
+             *
+             * @return pointer to the element, nullptr if the key is stale, valid until the slot map is modified
+             */
+            T* get(Key key) {
+                return has(key) ? &m_values[m_slots[key.index].index] : nullptr;
+            }
+            /**//**
+             * \brief Get the element of a key.
+             *
+             * @param key Key of the element to be accessed
+             *
+             * @return pointer to the element, nullptr if the key is stale, valid until the slot map is modified
+             */
+            const T* get(Key key) const {
+                return has(key) ? &m_values[m_slots[key.index].index] : nullptr;
+            }
+
+            /**//**
+             * \brief Check if the element of a key still exists.
+             *
+             * @param key Key of the element to be checked
+             *
+             * @return true if the key refers to an element, false if it is stale
+             */
+            bool has(Key key) const {
+                return key.index < m_slots.size() && m_slots[key.index].generation == key.generation && (key.generation & 1u);
+            }
+
+            /**//**
+             * \brief Get the key of an element by its position in the dense array.
+             *
+             * Allows to erase elements found while iterating.
+             *
+             * @param position index of the element, smaller than size()
+             *
+             * @return Key of the element
+             */
+            Key getKey(size_t position) const {
+                uint32_t slot = m_owners[position];
+                return {slot, m_slots[slot].generation};
+            }
+
+            /**//**
+             * \brief Get the number of elements.
+             *
+             * @return number of elements
+             */
+            size_t size() const noexcept { return m_values.size(); }
+            /**//**
+             * \brief Check if the slot map has no elements.
+             *
+             * @return true if empty
+             */
+            bool empty() const noexcept { return m_values.empty(); }
+
+            /**//**
+             * \brief Reserve memory for elements.
+             *
+             * @param capacity number of elements which can be inserted without reallocation
+             */
+            void reserve(size_t capacity) {
+                m_values.reserve(capacity);
+                m_owners.reserve(capacity);
+                m_slots.reserve(capacity);
+            }
+
+            /**//**
+             * \brief Clear the slot map.
+             *
+             * Removes all elements, their keys become stale.
+             */
+            void clear() {
+                for (uint32_t slot : m_owners) {
+                    release(slot);
+                }
+                m_values.clear();
+                m_owners.clear();
+            }
+
+            /// iterator over the dense array of elements
+            using iterator = typename std::vector<T>::iterator;
+            /// const iterator over the dense array of elements
+            using const_iterator = typename std::vector<T>::const_iterator;
+
+            /**//**
+             * \brief Get iterator of the first element.
+             *
+             * @return begin iterator to the dense array
+             */
+            iterator begin() noexcept { return m_values.begin(); }
+            /**//**
+             * \brief Get iterator behind the last element.
+             *
+             * @return end iterator to the dense array
+             */
+            iterator end() noexcept { return m_values.end(); }
+            /**//**
+             * \brief Get iterator of the first element.
+             *
+             * @return begin iterator to the dense array
+             */
+            const_iterator begin() const noexcept { return m_values.begin(); }
+            /**//**
+             * \brief Get iterator behind the last element.
+             *
+             * @return end iterator to the dense array
+             */
+            const_iterator end() const noexcept { return m_values.end(); }
+
+            private:
+            void release(uint32_t slot) {
+                Slot& entry = m_slots[slot];
+                // skips the unused generation 0 of default keys after wrapping around
+                entry.generation = entry.generation + 1 == 0 ? 2 : entry.generation + 1;
+                entry.index = m_freeSlot;
+                m_freeSlot = slot;
+            }
+        };
+
+    }
+}
+
+#endif
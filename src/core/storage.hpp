@@ -12,7 +12,7 @@ namespace tme {
     namespace core {
 
         /// type used for identifiers throughout the codebase
-        using Identifier = uint32_t;
+        using Identifier = uint64_t;
 
         /// type alias for a shared ptr to T
         template<typename T>
@@ -7,6 +7,7 @@
 #include "core/events/window.hpp"
 #include "core/events/key.hpp"
 #include "core/events/mouse.hpp"
+#include "core/graphics/state.hpp"
 
 #include "imgui.h"
 #include "backends/imgui_impl_opengl3.h"
@@ -69,6 +70,8 @@ namespace tme {
             
             // load gl
             TME_ASSERT(gladLoadGLLoader((GLADloadproc) glfwGetProcAddress), "glad could not load opengl loader");
+            // nothing is bound in the new context
+            core::graphics::State::global().reset();
 
             setupCallbacks();
 
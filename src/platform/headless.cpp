@@ -0,0 +1,163 @@
+/** @file */
+#include <cstring>
+#include <memory>
+#include "platform/headless.hpp"
+#include "EGL/eglext.h"
+#include "core/log.hpp"
+#include "core/window.hpp"
+#include "core/events/window.hpp"
+#include "core/graphics/state.hpp"
+
+#include "imgui.h"
+#include "backends/imgui_impl_opengl3.h"
+
+namespace tme {
+
+    namespace core {
+        Window* Window::create(const Window::Data& data) {
+            return new platform::HeadlessWindow(data);
+        }
+    }
+
+
+    namespace platform {
+
+        EGLDisplay HeadlessContext::s_display = EGL_NO_DISPLAY;
+
+        std::unique_ptr<Context> Context::create() {
+            return std::make_unique<HeadlessContext>();
+        }
+
+        HeadlessContext::HeadlessContext() {
+            const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay) {
+                s_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+            if (s_display == EGL_NO_DISPLAY) {
+                s_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+            }
+            EGLint major = 0, minor = 0;
+            if (s_display == EGL_NO_DISPLAY || !eglInitialize(s_display, &major, &minor)) {
+                TME_ERROR("[EGL] ({}): could not initialize display", eglGetError());
+                s_display = EGL_NO_DISPLAY;
+            }
+            TME_ASSERT(s_display != EGL_NO_DISPLAY, "failed to initialize egl");
+            TME_INFO("initialized egl {}.{}", major, minor);
+        }
+
+        HeadlessContext::~HeadlessContext() {
+            if (s_display != EGL_NO_DISPLAY) {
+                eglTerminate(s_display);
+                s_display = EGL_NO_DISPLAY;
+            }
+            TME_INFO("terminated egl");
+        }
+
+        HeadlessWindow::HeadlessWindow(const BaseWindow::Data& data)
+            : BaseWindow(data),
+            m_context(EGL_NO_CONTEXT),
+            m_frameBuffer(0),
+            m_colorBuffer(0),
+            m_depthBuffer(0),
+            m_lastUpdate(std::chrono::steady_clock::now()) {
+            TME_TRACE("creating {}", *this);
+
+            EGLDisplay display = HeadlessContext::getDisplay();
+            const EGLint configAttributes[] = {
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_NONE
+            };
+            const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+            };
+            if (display != EGL_NO_DISPLAY && eglBindAPI(EGL_OPENGL_API)) {
+                EGLConfig config = EGL_NO_CONFIG_KHR;
+                EGLint configCount = 0;
+                // surfaceless displays may not offer desktop gl configs, no config is needed without a surface
+                if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount < 1) {
+                    config = EGL_NO_CONFIG_KHR;
+                }
+                m_context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+            }
+            // surfaceless contexts render into framebuffer objects only
+            if (m_context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context)) {
+                TME_ERROR("[EGL] ({}): could not create context", eglGetError());
+                // guarantees a debugger trap
+                TME_ASSERT(false, "could not create window");
+                // early exit to avoid seg faults
+                return;
+            }
+
+            // load gl, outside of the assertion as it is compiled out in release builds
+            if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+                TME_ASSERT(false, "glad could not load opengl loader");
+                return;
+            }
+            // nothing is bound in the new context
+            core::graphics::State::global().reset();
+
+            // the framebuffer object takes the place of the default framebuffer, nothing binds another one
+            glCall(glGenRenderbuffers(1, &m_colorBuffer));
+            glCall(glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer));
+            glCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, static_cast<GLsizei>(m_data.width), static_cast<GLsizei>(m_data.height)));
+            glCall(glGenRenderbuffers(1, &m_depthBuffer));
+            glCall(glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer));
+            glCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(m_data.width), static_cast<GLsizei>(m_data.height)));
+            glCall(glGenFramebuffers(1, &m_frameBuffer));
+            glCall(glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer));
+            glCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer));
+            glCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer));
+            TME_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "offscreen framebuffer is incomplete");
+            glCall(glViewport(0, 0, static_cast<GLsizei>(m_data.width), static_cast<GLsizei>(m_data.height)));
+
+            ImGui_ImplOpenGL3_Init("#version 330");
+
+            TME_INFO("created {}", *this);
+        }
+
+        HeadlessWindow::~HeadlessWindow() {
+            if (m_context != EGL_NO_CONTEXT) {
+                ImGui_ImplOpenGL3_Shutdown();
+                glCall(glDeleteFramebuffers(1, &m_frameBuffer));
+                glCall(glDeleteRenderbuffers(1, &m_colorBuffer));
+                glCall(glDeleteRenderbuffers(1, &m_depthBuffer));
+                EGLDisplay display = HeadlessContext::getDisplay();
+                eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                eglDestroyContext(display, m_context);
+            }
+            TME_INFO("destroyed {}", *this);
+        }
+
+        void HeadlessWindow::update() {
+            auto currentUpdate = std::chrono::steady_clock::now();
+            core::events::WindowUpdate updateEvent(std::chrono::duration<double>(currentUpdate - m_lastUpdate).count());
+            m_lastUpdate = currentUpdate;
+            if (m_data.handler) {
+                m_data.handler->onEvent(updateEvent);
+            }
+        }
+
+        void HeadlessWindow::swapBuffer() {
+            // there is nothing to present, submit the frame so it does not pile up
+            glCall(glFlush());
+        }
+
+        void HeadlessWindow::pollEvents() {}
+
+        void HeadlessWindow::setTitleInternal(const std::string&) {}
+
+        void HeadlessWindow::setVSyncInternal(bool) {}
+
+        void HeadlessWindow::readPixels(unsigned char* pixels) const {
+            glCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBuffer));
+            core::graphics::State::global().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+            glCall(glReadPixels(0, 0, static_cast<GLsizei>(m_data.width), static_cast<GLsizei>(m_data.height), GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+        }
+
+    }
+}
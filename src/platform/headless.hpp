@@ -0,0 +1,85 @@
+/** @file */
+#ifndef _PLATFORM_HEADLESS_H
+#define _PLATFORM_HEADLESS_H
+
+#include <chrono>
+#include "core/graphics/gl.hpp"
+#include "EGL/egl.h"
+#include "core/window.hpp"
+#include "platform/context.hpp"
+
+namespace tme {
+    namespace platform {
+
+        /**//**
+         * \brief EGL implementation of a platform context without a display.
+         *
+         * Uses the surfaceless platform of Mesa if available, so no display server is needed.
+         * Falls back to the default display otherwise.
+         */
+        class HeadlessContext : public platform::Context {
+            static EGLDisplay s_display;
+
+            public:
+            /**//**
+             * \brief Initialize EGL.
+             */
+            HeadlessContext();
+            /**//**
+             * \brief Terminate EGL.
+             */
+            ~HeadlessContext();
+
+            /**//**
+             * \brief Get the initialized display.
+             *
+             * @return the EGL display, EGL_NO_DISPLAY if no HeadlessContext exists
+             */
+            static EGLDisplay getDisplay() { return s_display; }
+        };
+
+        /**//**
+         * \brief Window implementation rendering offscreen.
+         *
+         * Creates an OpenGL 3.3 core context without a surface and binds a framebuffer object of the
+         * window size as default render target. It never receives input, updates report the time passed
+         * since the last update. Used for tests, benchmarks and exports on machines without a display.
+         */
+        class HeadlessWindow : public core::Window {
+            using BaseWindow = core::Window;
+
+            EGLContext m_context;
+            GLuint m_frameBuffer;
+            GLuint m_colorBuffer;
+            GLuint m_depthBuffer;
+            std::chrono::steady_clock::time_point m_lastUpdate;
+
+            public:
+            /**//**
+             * \brief Construct offscreen window instance from data.
+             *
+             * @param data window data to be passed to Window constructor, the size is the size of the framebuffer
+             */
+            HeadlessWindow(const BaseWindow::Data& data);
+            ~HeadlessWindow();
+
+            void update() override;
+            void swapBuffer() override;
+            void pollEvents() override;
+            void setTitleInternal(const std::string& title) override;
+            void setVSyncInternal(bool enable) override;
+
+            /**//**
+             * \brief Read the rendered image.
+             *
+             * Waits for all rendering to finish.
+             *
+             * @param pixels receives width * height RGBA pixels with 8 bits per channel, rows starting at the bottom
+             */
+            void readPixels(unsigned char* pixels) const;
+        };
+
+    }
+}
+
+#endif
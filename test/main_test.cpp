@@ -12,20 +12,35 @@ int SignalCounter::assertionFailed = SIGTRAP;
 #include "core/events/key_test.cpp"
 #include "core/events/mouse_test.cpp"
 #include "core/window_test.cpp"
+#ifdef TME_HEADLESS
+#include "platform/headless_test.cpp"
+#else
 #include "platform/glfw_test.cpp"
+#endif
 #include "core/layers/layer_test.cpp"
 #include "core/layers/imgui_test.cpp"
 #include "core/storage_test.cpp"
+#include "core/slotmap_test.cpp"
+#include "core/queue_test.cpp"
 #include "core/application_test.cpp"
+#include "core/graphics/state_test.cpp"
 #include "core/graphics/buffer_test.cpp"
 #include "core/graphics/index_test.cpp"
 #include "core/graphics/vertex_test.cpp"
 #include "core/graphics/texture_test.cpp"
+#include "core/graphics/cache_test.cpp"
+#include "core/graphics/atlas_test.cpp"
+#include "core/graphics/loader_test.cpp"
 #include "core/graphics/shader_test.cpp"
 #include "core/graphics/batch_test.cpp"
+#include "core/graphics/renderqueue_test.cpp"
+#include "core/graphics/profiler_test.cpp"
+#include "app/mapfile_test.cpp"
 
 int main(int argc, char** argv) {
     SignalCounter::instance()->listen(SignalCounter::assertionFailed);
+    // tests must not store entries in the texture cache of the user
+    tme::core::graphics::TextureCache::configureGlobal("", tme::core::graphics::TextureCache::DEFAULT_MAX_BYTES);
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,161 @@
+#include "core/graphics/base.hpp"
+
+#include "app/mapfile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "core/exceptions/input.hpp"
+#include "core/events/window.hpp"
+#include "app/graphics/color.hpp"
+#include "app/layers/map.hpp"
+#include "app/tilemap.hpp"
+
+namespace tme {
+    namespace app {
+
+        class MapFileTest : public core::graphics::GraphicsTest {
+            protected:
+            const char* m_path = "mapfile-test.tmem";
+            const char* m_brokenPath = "mapfile-test-broken.tmem";
+
+            void TearDown() override {
+                std::remove(m_path);
+                std::remove(m_brokenPath);
+                core::graphics::GraphicsTest::TearDown();
+            }
+
+            void writeExample() {
+                Tilemap tilemap(40, 70, 16);
+                tilemap.setBackground(glm::vec4(0.1f, 0.2f, 0.3f, 1.0f));
+                tilemap.addLayer();
+
+                // place a single tile on the second layer
+                auto factory = std::make_shared<graphics::ColorTileFactory>();
+                factory->setColor(glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+                factory->setPosition(3, 37);
+                auto cursor = tilemap.getCursor();
+                cursor->tileFactory = factory;
+                cursor->layer = 1;
+                cursor->inBounds = true;
+                cursor->placeTile = true;
+                core::events::WindowUpdate update(0.0);
+                tilemap.onEvent(update);
+                cursor->placeTile = false;
+
+                MapFile::write(m_path, tilemap);
+            }
+
+            std::vector<char> readExample() {
+                std::ifstream file(m_path, std::ios::binary);
+                return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+
+            void writeBroken(const std::vector<char>& data) {
+                std::ofstream file(m_brokenPath, std::ios::binary | std::ios::trunc);
+                file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            }
+
+            void writeBroken(const MapFile::Header& header) {
+                std::vector<char> data = readExample();
+                std::memcpy(data.data(), &header, sizeof(header));
+                writeBroken(data);
+            }
+        };
+
+        TEST_F(MapFileTest, WriteRead) {
+            writeExample();
+            MapFile file(m_path);
+            const auto& header = file.getHeader();
+            EXPECT_EQ(header.version, MapFile::VERSION);
+            EXPECT_EQ(header.width, 40u);
+            EXPECT_EQ(header.height, 70u);
+            EXPECT_EQ(header.tileSize, 16u);
+            EXPECT_EQ(header.chunkSize, layers::MapLayer::getChunkSize());
+            ASSERT_EQ(header.layerCount, 2u);
+            EXPECT_EQ(header.kindCount, 1u);
+            EXPECT_EQ(header.hasBackground, 1u);
+            EXPECT_FLOAT_EQ(header.background[2], 0.3f);
+
+            // the tile is in the second chunk row, the first layer stays empty
+            uint32_t chunkSize = header.chunkSize;
+            for (uint32_t y = 0; y < 3; ++y) {
+                for (uint32_t x = 0; x < 2; ++x) {
+                    const TileGrid::Kind* first = file.getChunk(0, x, y);
+                    const TileGrid::Kind* second = file.getChunk(1, x, y);
+                    for (uint32_t i = 0; i < chunkSize * chunkSize; ++i) {
+                        EXPECT_EQ(first[i], TileGrid::EMPTY);
+                        bool placed = x == 0 && y == 1 && i == (37 - chunkSize) * chunkSize + 3;
+                        EXPECT_EQ(second[i], placed ? 1 : TileGrid::EMPTY);
+                    }
+                }
+            }
+
+            EXPECT_TRUE(file.createPrototypes(0).empty());
+            auto prototypes = file.createPrototypes(1);
+            ASSERT_EQ(prototypes.size(), 1u);
+            const auto* color = dynamic_cast<const graphics::ColorTile*>(prototypes[0].get());
+            ASSERT_NE(color, nullptr);
+            EXPECT_EQ(color->getColor(), glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+        }
+
+        TEST_F(MapFileTest, Truncated) {
+            writeExample();
+            std::vector<char> data = readExample();
+
+            // chunks of the last layer are missing
+            data.resize(data.size() - 1);
+            writeBroken(data);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            // not even a complete header
+            data.resize(sizeof(MapFile::Header) - 1);
+            writeBroken(data);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+        }
+
+        TEST_F(MapFileTest, InvalidHeader) {
+            writeExample();
+            MapFile::Header header;
+            std::memcpy(&header, readExample().data(), sizeof(header));
+
+            // dimensions whose chunks would not fit into 64 bits
+            MapFile::Header broken = header;
+            broken.width = std::numeric_limits<uint32_t>::max();
+            broken.height = std::numeric_limits<uint32_t>::max();
+            writeBroken(broken);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            broken = header;
+            broken.height = 0;
+            writeBroken(broken);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            // only the chunk size of the map layers is supported
+            broken = header;
+            broken.chunkSize = std::numeric_limits<uint32_t>::max();
+            writeBroken(broken);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            broken = header;
+            broken.chunkSize = 0;
+            writeBroken(broken);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            // table reaching past the end of the file
+            broken = header;
+            broken.kindTable = std::numeric_limits<uint64_t>::max() - 7;
+            writeBroken(broken);
+            ASSERT_THROW(MapFile file(m_brokenPath), core::exceptions::InvalidInput);
+
+            // the unmodified header is still valid
+            writeBroken(header);
+            MapFile file(m_brokenPath);
+            EXPECT_EQ(file.getHeader().width, 40u);
+        }
+
+    }
+}
@@ -0,0 +1,97 @@
+#include "core/graphics/base.hpp"
+
+#include "core/graphics/atlas.hpp"
+#include "core/graphics/texture.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TEST(TestAtlas, MapRegion) {
+                Atlas::Region region;
+                region.x = 0.5f;
+                region.y = 0.25f;
+                region.width = 0.5f;
+                region.height = 0.25f;
+                glm::vec4 mapped = region.map(glm::vec4(0.0f, 0.0f, 1.0f, 0.5f));
+                EXPECT_FLOAT_EQ(mapped.x, 0.5f);
+                EXPECT_FLOAT_EQ(mapped.y, 0.25f);
+                EXPECT_FLOAT_EQ(mapped.z, 1.0f);
+                EXPECT_FLOAT_EQ(mapped.w, 0.375f);
+            }
+
+            TEST_F(GraphicsTest, EmptyTextureSetPixels) {
+                Texture tex(4, 2);
+                EXPECT_EQ(tex.getWidth(), 4);
+                EXPECT_EQ(tex.getHeight(), 2);
+                // the content of an empty texture is undefined
+                std::vector<unsigned char> black(4 * 2 * 4, 0);
+                tex.setPixels(0, 0, 4, 2, black.data());
+                std::vector<unsigned char> white(2 * 2 * 4, 255);
+                tex.setPixels(1, 0, 2, 2, white.data());
+                auto pixels = tex.getPixels();
+                ASSERT_EQ(pixels.size(), 4u * 2u * 4u);
+                EXPECT_EQ(pixels[0], 0);
+                EXPECT_EQ(pixels[4], 255);
+                EXPECT_EQ(pixels[8], 255);
+                EXPECT_EQ(pixels[12], 0);
+            }
+
+            TEST_F(GraphicsTest, PackTextures) {
+                const char* path = "../test/res/example.png";
+                Texture first(path);
+                Texture second(path);
+                Atlas atlas(1024);
+
+                auto region = atlas.add(first);
+                ASSERT_NE(region, nullptr);
+                EXPECT_EQ(atlas.getPageCount(), 1u);
+                EXPECT_NE(atlas.getPage(region->page), nullptr);
+                EXPECT_FLOAT_EQ(region->x, 0.0f);
+                EXPECT_FLOAT_EQ(region->y, 0.0f);
+                EXPECT_FLOAT_EQ(region->width, 700.0f / 1024.0f);
+                EXPECT_EQ(atlas.add(first), region);
+                EXPECT_EQ(atlas.find(first), region);
+
+                // does not fit next to or above the first one
+                auto other = atlas.add(second);
+                ASSERT_NE(other, nullptr);
+                EXPECT_EQ(atlas.getPageCount(), 2u);
+                EXPECT_NE(other->page, region->page);
+
+                atlas.clear();
+                EXPECT_EQ(atlas.getPageCount(), 0u);
+                EXPECT_EQ(atlas.find(first), nullptr);
+            }
+
+            TEST_F(GraphicsTest, PackReusedTextureId) {
+                Atlas atlas(64);
+                {
+                    Texture first(4, 4);
+                    ASSERT_NE(atlas.add(first), nullptr);
+                }
+                // a texture created later may get the id of the deleted one
+                Texture second(8, 8);
+                EXPECT_EQ(atlas.find(second), nullptr);
+                auto region = atlas.add(second);
+                ASSERT_NE(region, nullptr);
+                EXPECT_FLOAT_EQ(region->width, 8.0f / 64.0f);
+            }
+
+            TEST_F(GraphicsTest, PackTooLargeTexture) {
+                Texture tex("../test/res/example.png");
+                Atlas atlas(512);
+                EXPECT_EQ(atlas.add(tex), nullptr);
+                EXPECT_EQ(atlas.getPageCount(), 0u);
+            }
+
+            TEST_F(GraphicsTest, PackTextureWithOtherOptions) {
+                Texture tex(8, 8, {Texture::RGBA8, true});
+                Atlas atlas(64);
+                EXPECT_EQ(atlas.add(tex), nullptr);
+                EXPECT_EQ(atlas.getPageCount(), 0u);
+            }
+
+        }
+    }
+}
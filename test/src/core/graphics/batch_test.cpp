@@ -2,6 +2,7 @@
 #include "core/graphics/base.hpp"
 
 #include "core/graphics/batch.hpp"
+#include "core/graphics/state.hpp"
 #include "core/exceptions/input.hpp"
 
 namespace tme {
@@ -15,24 +16,30 @@ namespace tme {
                 Identifier id;
                 unsigned int indexOffset;
                 size_t sizeDiff;
+                bool instanced;
+                bool missingLayout = false;
 
                 static uint32_t preRenderHookCount;
 
-                _ExampleData(size_t indexSizeDiff = 0) : id(uuid<_ExampleData>()), sizeDiff(indexSizeDiff) {
+                _ExampleData(size_t indexSizeDiff = 0, bool instancedRendering = false) : id(uuid<_ExampleData>()), sizeDiff(indexSizeDiff), instanced(instancedRendering) {
                     
                 }
 
                 Batch::Config getBatchConfig() const override {
+                    // shared by all objects so they get the same config, recreated once a test cleared the global layouts
+                    static Handle<VertexLayout> layout;
                     auto layouts = Storage<VertexLayout>::global();
-                    auto layout = layouts->create();
-                    layout->push<float>(2);
-                    layout->push<float>(2);
+                    if (!layout || !layouts->has(layout->getId())) {
+                        layout = layouts->create();
+                        layout->push<float>(2);
+                        layout->push<float>(2);
+                    }
 
-                    static Batch::Config::Vertex vertex(4, sizeof(float) * 4, layout->getId());
+                    Batch::Config::Vertex vertex(4, sizeof(float) * 4, missingLayout ? static_cast<Identifier>(-1) : layout->getId());
                     Batch::Config::Index index(1, sizeof(unsigned int) * (6 + sizeDiff), 6);
                     Batch::Config config(vertex, index, [](Identifier, Identifier){
                             ++preRenderHookCount;
-                        }, 0);
+                        }, 0, NO_TEXTURE, instanced);
                     return config;
                 }
 
@@ -53,6 +60,19 @@ namespace tme {
                 EXPECT_EQ(b.getConfig(), config);
             }
 
+            TEST_F(GraphicsTest, HashBatchConfig) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create(1);
+                Batch::Config::Hash hash;
+                EXPECT_EQ(hash(data1->getBatchConfig()), hash(data1->getBatchConfig()));
+                EXPECT_NE(hash(data1->getBatchConfig()), hash(data2->getBatchConfig()));
+
+                auto config = data1->getBatchConfig();
+                config.textureId = 1;
+                EXPECT_NE(hash(data1->getBatchConfig()), hash(config));
+            }
+
             TEST_F(GraphicsTest, CreateBatchWithoutLayout) {
                 auto dataStore = Storage<_ExampleData>::localInstance();
                 auto data = dataStore->create();
@@ -71,8 +91,8 @@ namespace tme {
 
                 Batch::Entry de1;
                 Batch::Entry de2;
-                ASSERT_NO_THROW(de1 = b.add(data1));
-                ASSERT_NO_THROW(de2 = b.add(data2));
+                ASSERT_NO_THROW(de1 = b.add(*data1));
+                ASSERT_NO_THROW(de2 = b.add(*data2));
 
                 EXPECT_EQ(data1->indexOffset, 0);
                 EXPECT_EQ(data2->indexOffset, 4);
@@ -100,9 +120,74 @@ namespace tme {
                 ASSERT_NO_THROW(Batch b(2, config));
                 Batch b(2, config);
 
-                ASSERT_NO_THROW(b.add(data1));
-                ASSERT_NO_THROW(b.add(data2));
-                EXPECT_THROW(b.add(data3), exceptions::InsufficientBufferSpace);
+                ASSERT_NO_THROW(b.add(*data1));
+                ASSERT_NO_THROW(b.add(*data2));
+                EXPECT_THROW(b.add(*data3), exceptions::InsufficientBufferSpace);
+            }
+
+            TEST_F(GraphicsTest, GrowBatch) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create();
+                auto data3 = dataStore->create();
+                auto config = data1->getBatchConfig();
+                Batch b(2, config, true);
+                EXPECT_EQ(b.getSize(), 2);
+
+                Batch::Entry de1;
+                Batch::Entry de3;
+                ASSERT_NO_THROW(de1 = b.add(*data1));
+                ASSERT_NO_THROW(b.add(*data2));
+                ASSERT_NO_THROW(de3 = b.add(*data3));
+                EXPECT_EQ(b.getSize(), 4);
+
+                // previous entries are unaffected
+                EXPECT_EQ(de1.vertexSpace.offset, 0);
+                EXPECT_EQ(de1.indexSpace.offset, 0);
+                EXPECT_EQ(de3.vertexSpace.offset, 8);
+                EXPECT_EQ(de3.indexSpace.offset, 2);
+                EXPECT_EQ(data3->indexOffset, 8);
+
+                // smaller sizes are ignored
+                b.resize(1);
+                EXPECT_EQ(b.getSize(), 4);
+            }
+
+            TEST_F(GraphicsTest, AddValuesToInstancedBatch) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create(0, true);
+                auto data2 = dataStore->create(0, true);
+                auto data3 = dataStore->create(0, true);
+                auto config = data1->getBatchConfig();
+                EXPECT_FALSE(config == dataStore->create()->getBatchConfig());
+                Batch b(1, config, true);
+                EXPECT_EQ(b.getInstanceCount(), 0);
+
+                Batch::Entry de1;
+                Batch::Entry de2;
+                ASSERT_NO_THROW(de1 = b.add(*data1));
+                ASSERT_NO_THROW(de2 = b.add(*data2));
+                ASSERT_NO_THROW(b.add(*data3));
+                EXPECT_EQ(b.getSize(), 4);
+                EXPECT_EQ(b.getInstanceCount(), 3);
+
+                // index data is shared by all instances
+                EXPECT_EQ(data1->indexOffset, 0);
+                EXPECT_EQ(de1.indexSpace.offset, 0);
+                EXPECT_EQ(de2.indexSpace.offset, 0);
+                EXPECT_EQ(de2.indexSpace.size, 1);
+                EXPECT_EQ(de2.vertexSpace.offset, 4);
+
+                b.remove(de2);
+                EXPECT_EQ(b.getInstanceCount(), 3);
+
+                // all instances are drawn with one call, each from the two shared triangles
+                State::global().resetCounters();
+                uint32_t counterBefore = _ExampleData::preRenderHookCount;
+                b.render();
+                EXPECT_EQ(_ExampleData::preRenderHookCount, counterBefore + 1);
+                EXPECT_EQ(State::global().getDrawCount(), 1u);
+                EXPECT_EQ(State::global().getPrimitiveCount(), 6u);
             }
 
             TEST_F(GraphicsTest, UpdateAndRemoveFromBatch) {
@@ -116,42 +201,106 @@ namespace tme {
 
                 Batch::Entry de1;
                 Batch::Entry de2;
-                ASSERT_NO_THROW(de1 = b.add(data1));
-                ASSERT_NO_THROW(de2 = b.add(data2));
-                EXPECT_THROW(b.add(data3), exceptions::InsufficientBufferSpace);
-                b.update(de2, data2);
+                ASSERT_NO_THROW(de1 = b.add(*data1));
+                ASSERT_NO_THROW(de2 = b.add(*data2));
+                EXPECT_THROW(b.add(*data3), exceptions::InsufficientBufferSpace);
+                b.update(de2, *data2);
                 b.remove(de2);
 
                 Batch::Entry de3;
-                EXPECT_NO_THROW(de3 = b.add(data3));
+                EXPECT_NO_THROW(de3 = b.add(*data3));
                 EXPECT_EQ(de3.vertexSpace.offset, de2.vertexSpace.offset);
                 EXPECT_EQ(de3.vertexSpace.size, de2.vertexSpace.size);
                 EXPECT_EQ(de3.indexSpace.offset, de2.indexSpace.offset);
                 EXPECT_EQ(de3.indexSpace.size, de2.indexSpace.size);
             }
 
+            TEST_F(GraphicsTest, DrawFragmentedBatch) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create();
+                auto data3 = dataStore->create();
+                Batch b(3, data1->getBatchConfig());
+                b.add(*data1);
+                auto de2 = b.add(*data2);
+                b.add(*data3);
+
+                b.render();
+                EXPECT_EQ(b.getDrawCommandCount(), 1);
+
+                // the removed object in between splits the draw into two ranges
+                b.remove(de2);
+                b.render();
+                EXPECT_EQ(b.getDrawCommandCount(), 2);
+            }
+
+            TEST_F(GraphicsTest, ShareBatchPool) {
+                Handle<BatchPool> pool(new BatchPool(1));
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create();
+                Batcher batcher1(pool);
+                batcher1.set(*data1);
+                {
+                    Batcher batcher2(pool);
+                    batcher2.set(*data2);
+
+                    // objects of the same config of both batchers are in the same batch
+                    EXPECT_NE(pool->getBatches().begin(), pool->getBatches().end());
+                    EXPECT_EQ(++pool->getBatches().begin(), pool->getBatches().end());
+                    EXPECT_EQ(pool->getBatches().begin()->getSize(), 2);
+
+                    uint32_t counterBefore = _ExampleData::preRenderHookCount;
+                    pool->render();
+                    EXPECT_EQ(_ExampleData::preRenderHookCount, counterBefore + 1);
+                }
+                // deleting a batcher removes its objects from the shared batch
+                auto& batch = *pool->getBatches().begin();
+                batch.render();
+                EXPECT_EQ(batch.getDrawCommandCount(), 1);
+                batcher1.unset(*data1);
+                batch.render();
+                EXPECT_EQ(batch.getDrawCommandCount(), 0);
+            }
+
             TEST_F(GraphicsTest, AddAndRemoveDataFromBatcher) {
                 Batcher batcher(3);
                 auto dataStore = Storage<_ExampleData>::localInstance();
                 auto data1 = dataStore->create();
                 auto data2 = dataStore->create();
                 auto data3 = dataStore->create();
-                batcher.set(data1);
-                batcher.set(data2);
-                batcher.set(data3);
+                batcher.set(*data1);
+                batcher.set(*data2);
+                batcher.set(*data3);
 
                 // should be only on batch
-                EXPECT_NE(batcher.getBatches()->begin(), batcher.getBatches()->end());
-                EXPECT_EQ(++batcher.getBatches()->begin(), batcher.getBatches()->end());
+                EXPECT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
 
                 auto data4 = dataStore->create();
                 // making room in full batch
-                batcher.unset(data2);
-                batcher.set(data4);
+                batcher.unset(*data2);
+                batcher.set(*data4);
 
                 // still only one batch
-                EXPECT_NE(batcher.getBatches()->begin(), batcher.getBatches()->end());
-                EXPECT_EQ(++batcher.getBatches()->begin(), batcher.getBatches()->end());
+                EXPECT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
+            }
+
+            TEST_F(GraphicsTest, GrowBatchInBatcher) {
+                Batcher batcher(1);
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create();
+                auto data3 = dataStore->create();
+                batcher.set(*data1);
+                batcher.set(*data2);
+                batcher.set(*data3);
+
+                // should be only one batch which grew to fit all objects
+                ASSERT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(batcher.getBatches().begin()->getSize(), 4);
             }
 
             TEST_F(GraphicsTest, UpdateDataInBatcher) {
@@ -160,26 +309,50 @@ namespace tme {
                 auto data1 = dataStore->create();
                 auto data2 = dataStore->create();
                 auto data3 = dataStore->create();
-                batcher.set(data1);
-                batcher.set(data2);
-                batcher.set(data3);
+                batcher.set(*data1);
+                batcher.set(*data2);
+                batcher.set(*data3);
 
                 // should be only on batch
-                EXPECT_NE(batcher.getBatches()->begin(), batcher.getBatches()->end());
-                EXPECT_EQ(++batcher.getBatches()->begin(), batcher.getBatches()->end());
+                EXPECT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
 
-                batcher.set(data1);
+                batcher.set(*data1);
 
                 // should not have changed
-                EXPECT_NE(batcher.getBatches()->begin(), batcher.getBatches()->end());
-                EXPECT_EQ(++batcher.getBatches()->begin(), batcher.getBatches()->end());
+                EXPECT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
 
                 auto data4 = dataStore->create(1);
                 data4->id = data3->id;
                 // data4 is now data3 with a different batch config -> create additional batch
-                batcher.set(data4);
-                EXPECT_NE(batcher.getBatches()->begin(), batcher.getBatches()->end());
-                EXPECT_EQ(++(++batcher.getBatches()->begin()), batcher.getBatches()->end());
+                batcher.set(*data4);
+                EXPECT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++(++batcher.getBatches().begin()), batcher.getBatches().end());
+            }
+
+            TEST_F(GraphicsTest, FailedConfigChangeInBatcher) {
+                Batcher batcher(3);
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data1 = dataStore->create();
+                auto data2 = dataStore->create();
+                batcher.set(*data1);
+                batcher.set(*data2);
+
+                // no batch can be created for the new config, data1 is only removed from its old batch
+                data1->missingLayout = true;
+                batcher.set(*data1);
+                auto data3 = dataStore->create();
+                batcher.set(*data3);
+                // must not remove the space of data1 which has been given to data3
+                batcher.unset(*data1);
+
+                ASSERT_NE(batcher.getBatches().begin(), batcher.getBatches().end());
+                EXPECT_EQ(++batcher.getBatches().begin(), batcher.getBatches().end());
+                State::global().resetCounters();
+                batcher.render();
+                // two triangles each for data2 and data3
+                EXPECT_EQ(State::global().getPrimitiveCount(), 4u);
             }
 
             TEST_F(GraphicsTest, RenderBatcher) {
@@ -188,9 +361,9 @@ namespace tme {
                 auto data1 = dataStore->create();
                 auto data2 = dataStore->create();
                 auto data3 = dataStore->create();
-                batcher.set(data1);
-                batcher.set(data2);
-                batcher.set(data3);
+                batcher.set(*data1);
+                batcher.set(*data2);
+                batcher.set(*data3);
 
                 uint32_t counterBefore = _ExampleData::preRenderHookCount;
                 batcher.render();
@@ -199,7 +372,7 @@ namespace tme {
 
                 auto data4 = dataStore->create(1);
                 // should create a different config -> additional batch
-                batcher.set(data4);
+                batcher.set(*data4);
 
                 counterBefore = _ExampleData::preRenderHookCount;
                 batcher.render();
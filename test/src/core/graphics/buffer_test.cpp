@@ -1,6 +1,7 @@
 #include "core/graphics/base.hpp"
 
 #include "core/graphics/buffer.hpp"
+#include "core/graphics/state.hpp"
 
 namespace tme {
     namespace core {
@@ -120,6 +121,167 @@ namespace tme {
                 EXPECT_EQ(m_bufferData[3], m_data[3]);
             }
 
+            TEST_F(BufferTest, MergeNeighbouringSpaces) {
+                m_data[0] = { 1.0f, 2.0f };
+                auto space1 = m_buffer->add(1, m_data);
+                auto space2 = m_buffer->add(1, m_data);
+                auto space3 = m_buffer->add(1, m_data);
+                m_buffer->add(1, m_data);
+                EXPECT_EQ(m_buffer->getFreeSpace(), 0);
+
+                m_buffer->remove(space1);
+                m_buffer->remove(space3);
+                // two separate single entry spaces
+                EXPECT_EQ(m_buffer->getFreeSpace(), 2);
+                EXPECT_EQ(m_buffer->getFreeSpaceCount(), 2);
+                EXPECT_EQ(m_buffer->getLargestFreeSpace(), 1);
+
+                m_buffer->remove(space2);
+                // merged into one space
+                EXPECT_EQ(m_buffer->getFreeSpace(), 3);
+                EXPECT_EQ(m_buffer->getFreeSpaceCount(), 1);
+                EXPECT_EQ(m_buffer->getLargestFreeSpace(), 3);
+
+                // fits into the merged space
+                m_data[1] = { 3.0f, 4.0f };
+                m_data[2] = { 5.0f, 6.0f };
+                auto space4 = m_buffer->add(3, m_data);
+                EXPECT_EQ(space4.offset, 0);
+                EXPECT_EQ(space4.size, 3);
+                EXPECT_EQ(m_buffer->getFreeSpaceCount(), 0);
+
+                // verify content
+                populateBufferData();
+                EXPECT_EQ(m_bufferData[0], m_data[0]);
+                EXPECT_EQ(m_bufferData[1], m_data[1]);
+                EXPECT_EQ(m_bufferData[2], m_data[2]);
+            }
+
+            TEST_F(BufferTest, UsedSpaces) {
+                m_data[0] = { 1.0f, 2.0f };
+                auto space1 = m_buffer->add(1, m_data);
+                m_buffer->add(1, m_data);
+                auto space3 = m_buffer->add(1, m_data);
+                m_buffer->add(1, m_data);
+
+                std::vector<Buffer::Space> spaces;
+                m_buffer->getUsedSpaces(spaces);
+                ASSERT_EQ(spaces.size(), 1);
+                EXPECT_EQ(spaces[0].offset, 0);
+                EXPECT_EQ(spaces[0].size, 4);
+
+                // used parts between the free spaces
+                m_buffer->remove(space1);
+                m_buffer->remove(space3);
+                m_buffer->getUsedSpaces(spaces);
+                ASSERT_EQ(spaces.size(), 2);
+                EXPECT_EQ(spaces[0].offset, 1);
+                EXPECT_EQ(spaces[0].size, 1);
+                EXPECT_EQ(spaces[1].offset, 3);
+                EXPECT_EQ(spaces[1].size, 1);
+            }
+
+            TEST_F(BufferTest, BestFitSplit) {
+                m_data[0] = { 1.0f, 2.0f };
+                auto space1 = m_buffer->add(1, m_data);
+                m_buffer->add(1, m_data);
+                auto space2 = m_buffer->add(2, m_data);
+                m_buffer->remove(space1);
+                m_buffer->remove(space2);
+                // space at the end is given back to the remainder of the buffer
+                EXPECT_EQ(m_buffer->getFreeSpaceCount(), 1);
+                EXPECT_EQ(m_buffer->getLargestFreeSpace(), 2);
+
+                // smallest fitting space is used
+                auto space3 = m_buffer->add(1, m_data);
+                EXPECT_EQ(space3.offset, 0);
+                EXPECT_EQ(m_buffer->getFreeSpaceCount(), 0);
+
+                // larger space is split
+                auto space4 = m_buffer->add(1, m_data);
+                EXPECT_EQ(space4.offset, 2);
+                EXPECT_EQ(m_buffer->getFreeSpace(), 1);
+                auto space5 = m_buffer->add(1, m_data);
+                EXPECT_EQ(space5.offset, 3);
+                EXPECT_EQ(m_buffer->getFreeSpace(), 0);
+            }
+
+            TEST_F(BufferTest, StreamingFlush) {
+                Buffer buffer(GL_ARRAY_BUFFER, Pair::size(), m_bufferSize, true);
+                EXPECT_TRUE(buffer.isStreaming());
+                m_data[0] = { 1.0f, 2.0f };
+                m_data[1] = { 3.0f, 4.0f };
+                auto space1 = buffer.add(1, m_data);
+                buffer.add(1, m_data + 1);
+                buffer.flush();
+                buffer.update(space1, m_data + 1);
+
+                // update is not uploaded before flush
+                buffer.bind();
+                glGetBufferSubData(GL_ARRAY_BUFFER, 0, 2 * Pair::size(), m_bufferData);
+                EXPECT_EQ(m_bufferData[0], m_data[0]);
+                EXPECT_EQ(m_bufferData[1], m_data[1]);
+
+                buffer.flush();
+                buffer.bind();
+                glGetBufferSubData(GL_ARRAY_BUFFER, 0, 2 * Pair::size(), m_bufferData);
+                EXPECT_EQ(m_bufferData[0], m_data[1]);
+                EXPECT_EQ(m_bufferData[1], m_data[1]);
+            }
+
+            TEST_F(BufferTest, StreamingManyRanges) {
+                Buffer buffer(GL_ARRAY_BUFFER, Pair::size(), 2, true);
+                Pair pairs[40];
+                for (size_t i = 0; i < 40; ++i) {
+                    pairs[i] = { static_cast<float>(i), 0.0f };
+                }
+                buffer.add(1, pairs);
+                buffer.flush();
+                // pending updates survive the growth of the buffer
+                buffer.resize(40);
+                buffer.update({ 0, 1 }, pairs + 1);
+                buffer.add(39, pairs + 1);
+                buffer.flush();
+
+                // every other entry changes, more ranges than are uploaded separately
+                Pair changed = { -1.0f, -1.0f };
+                for (GLsizeiptr i = 0; i < 40; i += 2) {
+                    buffer.update({ i, 1 }, &changed);
+                }
+                buffer.flush();
+
+                Pair result[40];
+                buffer.bind();
+                glGetBufferSubData(GL_ARRAY_BUFFER, 0, 40 * Pair::size(), result);
+                for (size_t i = 0; i < 40; ++i) {
+                    if (i % 2 == 0) {
+                        EXPECT_EQ(result[i], changed);
+                    } else {
+                        EXPECT_EQ(result[i], pairs[i]);
+                    }
+                }
+            }
+
+            TEST_F(BufferTest, CountUploadedBytes) {
+                Buffer buffer(GL_ARRAY_BUFFER, Pair::size(), m_bufferSize, true);
+                State::global().resetCounters();
+                auto space = buffer.add(2, m_data);
+                // streaming buffers upload with the flush
+                EXPECT_EQ(State::global().getUploadedBytes(), 0u);
+                buffer.flush();
+                EXPECT_EQ(State::global().getUploadedBytes(), 2 * Pair::size());
+
+                m_buffer->add(1, m_data);
+                EXPECT_EQ(State::global().getUploadedBytes(), 3 * Pair::size());
+
+                buffer.remove(space);
+                buffer.flush();
+                // the removed space is cleared
+                EXPECT_EQ(State::global().getUploadedBytes(), 5 * Pair::size());
+                State::global().resetCounters();
+                EXPECT_EQ(State::global().getUploadedBytes(), 0u);
+            }
+
             TEST_F(BufferTest, StringRepresentation) {
                 std::stringstream ss;
                 ss << "Buffer(" << m_buffer->getId() << ',' << GL_ARRAY_BUFFER << ',' << Pair::size() << ',' <<  m_bufferSize << ')';
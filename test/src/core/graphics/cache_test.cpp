@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+
+#include "core/graphics/cache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TEST(TestTextureCache, HashContent) {
+                const unsigned char first[] = {1, 2, 3};
+                const unsigned char second[] = {1, 2, 4};
+                EXPECT_EQ(TextureCache::hash(first, 3), TextureCache::hash(first, 3));
+                EXPECT_NE(TextureCache::hash(first, 3), TextureCache::hash(second, 3));
+                EXPECT_EQ(TextureCache::hash(first, 0), 14695981039346656037ull);
+            }
+
+            TEST(TestTextureCache, LoadFromCache) {
+                const char* directory = "texture-cache-test";
+                const char* path = "../test/res/example.png";
+                {
+                    TextureCache cache(directory);
+                    Image decoded = cache.load(path);
+                    ASSERT_NE(decoded.getPixels(), nullptr);
+                    EXPECT_FALSE(decoded.isCached());
+                    EXPECT_EQ(decoded.getWidth(), 700);
+                    EXPECT_EQ(decoded.getHeight(), 700);
+                    EXPECT_EQ(cache.getMisses(), 1u);
+
+                    Image cached = cache.load(path);
+                    ASSERT_NE(cached.getPixels(), nullptr);
+                    EXPECT_TRUE(cached.isCached());
+                    EXPECT_EQ(cached.getWidth(), 700);
+                    EXPECT_EQ(cached.getHeight(), 700);
+                    EXPECT_EQ(std::memcmp(decoded.getPixels(), cached.getPixels(), 700 * 700 * 4), 0);
+                    EXPECT_EQ(cache.getHits(), 1u);
+                }
+
+                // remove the entry again
+                std::ifstream file(path, std::ios::binary);
+                std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                std::stringstream entryPath;
+                entryPath << directory << '/' << std::hex << std::setw(16) << std::setfill('0')
+                    << TextureCache::hash(reinterpret_cast<const unsigned char*>(content.data()), content.size()) << ".rgba";
+                EXPECT_EQ(std::remove(entryPath.str().c_str()), 0);
+                rmdir(directory);
+            }
+
+            TEST(TestTextureCache, EvictLeastRecentlyUsed) {
+                const char* directory = "texture-cache-evict-test";
+                std::ifstream source("../test/res/example.png", std::ios::binary);
+                std::string content((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+                // copies of the image with different content hashes
+                std::string paths[3], entryPaths[3];
+                for (size_t i = 0; i < 3; ++i) {
+                    std::string copy = content + static_cast<char>(i);
+                    paths[i] = "texture-cache-evict-" + std::to_string(i) + ".png";
+                    std::ofstream(paths[i], std::ios::binary) << copy;
+                    std::stringstream entryPath;
+                    entryPath << directory << '/' << std::hex << std::setw(16) << std::setfill('0')
+                        << TextureCache::hash(reinterpret_cast<const unsigned char*>(copy.data()), copy.size()) << ".rgba";
+                    entryPaths[i] = entryPath.str();
+                }
+                auto exists = [](const std::string& path) {
+                    struct stat status;
+                    return stat(path.c_str(), &status) == 0;
+                };
+                auto setLastUse = [](const std::string& path, time_t time) {
+                    utimbuf times = {time, time};
+                    utime(path.c_str(), &times);
+                };
+
+                Image image = TextureCache("").load(paths[0]);
+                ASSERT_NE(image.getPixels(), nullptr);
+                uint64_t entryBytes = sizeof(TextureCache::EntryHeader) + static_cast<uint64_t>(image.getWidth()) * static_cast<uint64_t>(image.getHeight()) * 4;
+                {
+                    // room for two entries, even after evicting down to three quarters of the limit
+                    TextureCache cache(directory, entryBytes * 14 / 5);
+                    cache.load(paths[0]);
+                    cache.load(paths[1]);
+                    setLastUse(entryPaths[0], std::time(nullptr) - 100);
+                    setLastUse(entryPaths[1], std::time(nullptr) - 50);
+                    EXPECT_TRUE(cache.load(paths[0]).isCached());
+
+                    // the second entry has been used the longest time ago
+                    cache.load(paths[2]);
+                    EXPECT_TRUE(exists(entryPaths[0]));
+                    EXPECT_FALSE(exists(entryPaths[1]));
+                    EXPECT_TRUE(exists(entryPaths[2]));
+                }
+
+                for (size_t i = 0; i < 3; ++i) {
+                    std::remove(entryPaths[i].c_str());
+                    std::remove(paths[i].c_str());
+                }
+                rmdir(directory);
+            }
+
+            TEST(TestTextureCache, LoadInvalidFile) {
+                TextureCache cache("");
+                Image image = cache.load("../test/res/doesnotexist.png");
+                EXPECT_EQ(image.getPixels(), nullptr);
+                EXPECT_EQ(cache.getHits(), 0u);
+            }
+
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "core/graphics/base.hpp"
+
+#include "core/graphics/loader.hpp"
+#include "core/graphics/texture.hpp"
+#include <chrono>
+#include <thread>
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            // update until all pending loads have finished or a second has passed
+            static void waitForLoader(TextureLoader& loader) {
+                for (int i = 0; i < 1000 && loader.getPendingCount() > 0; ++i) {
+                    loader.update();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            TEST_F(GraphicsTest, LoadTextureAsync) {
+                TextureLoader loader(2);
+                const char* path = "../test/res/example.png";
+                Handle<Texture> loaded;
+                bool called = false;
+                auto texture = loader.load(path, [&](Handle<Texture> result) {
+                    called = true;
+                    loaded = result;
+                });
+                EXPECT_TRUE(texture->isPending());
+                EXPECT_TRUE(Storage<Texture>::global()->has(texture->getId()));
+                waitForLoader(loader);
+                ASSERT_TRUE(called);
+                ASSERT_EQ(loaded, texture);
+                EXPECT_FALSE(texture->isPending());
+                EXPECT_EQ(texture->getWidth(), 700);
+                EXPECT_EQ(texture->getHeight(), 700);
+                EXPECT_EQ(texture->getPixels(), Texture(path).getPixels());
+                Storage<Texture>::global()->destroy(texture->getId());
+                loader.clear();
+            }
+
+            TEST_F(GraphicsTest, LoadInvalidTextureAsync) {
+                TextureLoader loader(1);
+                bool called = false;
+                auto texture = loader.load("../test/res/doesnotexist.png", [&](Handle<Texture> result) {
+                    called = true;
+                    EXPECT_EQ(result, nullptr);
+                });
+                Identifier id = texture->getId();
+                texture = nullptr;
+                waitForLoader(loader);
+                EXPECT_TRUE(called);
+                EXPECT_FALSE(Storage<Texture>::global()->has(id));
+                loader.clear();
+            }
+
+            TEST_F(GraphicsTest, ReloadDestroyedTextureAsync) {
+                TextureLoader loader(1);
+                const char* path = "../test/res/example.png";
+                bool firstCalled = false;
+                auto first = loader.load(path, [&](Handle<Texture>) { firstCalled = true; });
+                Identifier firstId = first->getId();
+                // the placeholder is deleted while it is decoded, its OpenGL name may be reused right away
+                Storage<Texture>::global()->destroy(firstId);
+                first = nullptr;
+
+                Handle<Texture> loaded;
+                auto second = loader.load(path, [&](Handle<Texture> result) { loaded = result; });
+                waitForLoader(loader);
+                EXPECT_FALSE(firstCalled);
+                ASSERT_EQ(loaded, second);
+                EXPECT_FALSE(second->isPending());
+                EXPECT_EQ(loader.getPendingCount(), 0u);
+                Storage<Texture>::global()->destroy(second->getId());
+                loader.clear();
+            }
+
+        }
+    }
+}
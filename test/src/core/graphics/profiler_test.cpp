@@ -0,0 +1,138 @@
+#include "core/graphics/base.hpp"
+#include <sstream>
+
+#include "core/graphics/batch.hpp"
+#include "core/graphics/profiler.hpp"
+#include "core/graphics/renderqueue.hpp"
+#include "core/graphics/state.hpp"
+#include "core/graphics/vertex.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TEST_F(GraphicsTest, ProfileNestedSections) {
+                auto& profiler = Profiler::global();
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                Batch batch(2, dataStore->create()->getBatchConfig());
+                batch.add(*dataStore->create());
+                batch.add(*dataStore->create());
+
+                profiler.setEnabled(true);
+                // frames are resolved when their buffer is reused two frames later
+                for (int i = 0; i < 4; ++i) {
+                    profiler.beginFrame();
+                    EXPECT_TRUE(profiler.isRecording());
+                    {
+                        Profiler::Scope outer("Outer");
+                        State::global().countUpload(16);
+                        batch.draw();
+                        {
+                            Profiler::Scope inner("Inner");
+                            State::global().countDraw(4);
+                        }
+                        {
+                            Profiler::Scope inner("Inner");
+                            State::global().countDraw(4);
+                        }
+                    }
+                    {
+                        // same name at a different depth
+                        Profiler::Scope inner("Inner");
+                        State::global().countDraw(2);
+                    }
+                    profiler.endFrame();
+                    EXPECT_FALSE(profiler.isRecording());
+                    glFinish();
+                }
+
+                std::stringstream batchName;
+                batchName << "Batch " << batch.getId();
+                const auto& sections = profiler.getSections();
+                ASSERT_EQ(sections.size(), 5u);
+                EXPECT_EQ(sections[0]->name, "Frame");
+                EXPECT_EQ(sections[0]->depth, 0u);
+                EXPECT_EQ(sections[0]->statistics.drawCalls, 4u);
+                EXPECT_EQ(sections[1]->name, "Outer");
+                EXPECT_EQ(sections[1]->depth, 1u);
+                EXPECT_EQ(sections[1]->statistics.uploadedBytes, 16u);
+                EXPECT_EQ(sections[2]->name, batchName.str());
+                EXPECT_EQ(sections[2]->depth, 2u);
+                EXPECT_EQ(sections[2]->statistics.drawCalls, 1u);
+                EXPECT_EQ(sections[2]->statistics.primitives, 4u);
+                // sections of the same name are summed up
+                EXPECT_EQ(sections[3]->name, "Inner");
+                EXPECT_EQ(sections[3]->depth, 2u);
+                EXPECT_EQ(sections[3]->statistics.drawCalls, 2u);
+                EXPECT_EQ(sections[3]->statistics.primitives, 8u);
+                // but kept apart from those at other depths
+                EXPECT_EQ(sections[4]->name, "Inner");
+                EXPECT_EQ(sections[4]->depth, 1u);
+                EXPECT_EQ(sections[4]->statistics.drawCalls, 1u);
+                EXPECT_EQ(sections[4]->statistics.primitives, 2u);
+                EXPECT_GE(sections[0]->statistics.gpuTime, sections[1]->statistics.gpuTime);
+                EXPECT_GE(sections[1]->statistics.cpuTime, 0.0);
+
+                // nothing is recorded while disabled
+                profiler.setEnabled(false);
+                profiler.beginFrame();
+                EXPECT_FALSE(profiler.isRecording());
+                {
+                    Profiler::Scope ignored("Ignored");
+                }
+                profiler.endFrame();
+
+                profiler.clear();
+                EXPECT_TRUE(profiler.getSections().empty());
+            }
+
+            TEST_F(GraphicsTest, ProfileRenderQueueLayers) {
+                auto& profiler = Profiler::global();
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto config = dataStore->create()->getBatchConfig();
+                BatchPool firstPool(2);
+                BatchPool secondPool(2);
+                auto first = firstPool.getKey(config);
+                firstPool.find(first)->add(*dataStore->create());
+                auto second = secondPool.getKey(config);
+                secondPool.find(second)->add(*dataStore->create());
+                secondPool.find(second)->add(*dataStore->create());
+                RenderQueue queue;
+
+                profiler.setEnabled(true);
+                for (int i = 0; i < 4; ++i) {
+                    profiler.beginFrame();
+                    {
+                        // submitting layers draw nothing themselves
+                        Profiler::Scope submitting("Submitting");
+                        queue.submit(3, secondPool, second);
+                        queue.submit(1, firstPool, first);
+                    }
+                    queue.flush();
+                    profiler.endFrame();
+                    glFinish();
+                }
+
+                const auto& sections = profiler.getSections();
+                ASSERT_EQ(sections.size(), 6u);
+                EXPECT_EQ(sections[1]->name, "Submitting");
+                EXPECT_EQ(sections[1]->statistics.drawCalls, 0u);
+                // draws are charged to the layer they have been submitted to
+                EXPECT_EQ(sections[2]->name, "Layer 1");
+                EXPECT_EQ(sections[2]->depth, 1u);
+                EXPECT_EQ(sections[2]->statistics.drawCalls, 1u);
+                EXPECT_EQ(sections[2]->statistics.primitives, 2u);
+                EXPECT_EQ(sections[3]->depth, 2u);
+                EXPECT_EQ(sections[4]->name, "Layer 3");
+                EXPECT_EQ(sections[4]->depth, 1u);
+                EXPECT_EQ(sections[4]->statistics.drawCalls, 1u);
+                EXPECT_EQ(sections[4]->statistics.primitives, 4u);
+                EXPECT_EQ(sections[5]->depth, 2u);
+
+                profiler.setEnabled(false);
+                profiler.clear();
+            }
+
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#include "core/graphics/base.hpp"
+
+#include "core/graphics/batch.hpp"
+#include "core/graphics/renderqueue.hpp"
+#include "core/graphics/state.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TEST(TestRenderQueue, KeyOrder) {
+                // the layer dominates all other parts of the key
+                EXPECT_LT(RenderQueue::makeKey(0, 0xffff, 0xffff, 0xffff), RenderQueue::makeKey(1, 0, 0, 0));
+                EXPECT_LT(RenderQueue::makeKey(1, 0, 0xffff, 0xffff), RenderQueue::makeKey(1, 1, 0, 0));
+                EXPECT_LT(RenderQueue::makeKey(1, 1, 0, 0xffff), RenderQueue::makeKey(1, 1, 1, 0));
+                EXPECT_LT(RenderQueue::makeKey(1, 1, 1, 0), RenderQueue::makeKey(1, 1, 1, 1));
+            }
+
+            TEST_F(GraphicsTest, RenderQueueGroupsState) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto data = dataStore->create();
+                auto config = data->getBatchConfig();
+                auto other = config;
+                other.textureId = 1;
+                // a pool has one batch per config, the third batch is in a second pool
+                BatchPool pool(1);
+                BatchPool otherPool(1);
+                auto first = pool.getKey(config);
+                auto second = pool.getKey(other);
+                auto third = otherPool.getKey(config);
+
+                RenderQueue queue;
+                queue.submit(0, pool, first);
+                queue.submit(0, pool, second);
+                queue.submit(0, otherPool, third);
+                queue.submit(1, otherPool, third);
+                EXPECT_EQ(queue.getCommandCount(), 4u);
+
+                uint32_t counterBefore = _ExampleData::preRenderHookCount;
+                queue.flush();
+                // first and third are grouped, the second layer switches back from the texture of second
+                EXPECT_EQ(queue.getStateChanges(), 3u);
+                EXPECT_EQ(_ExampleData::preRenderHookCount, counterBefore + 3);
+                EXPECT_EQ(queue.getCommandCount(), 0u);
+
+                Storage<VertexLayout>::global()->clear();
+            }
+
+            TEST_F(GraphicsTest, RenderQueueGrowingPool) {
+                auto dataStore = Storage<_ExampleData>::localInstance();
+                auto config = dataStore->create()->getBatchConfig();
+                BatchPool pool(1);
+                pool.find(pool.getKey(config))->add(*dataStore->create());
+
+                RenderQueue queue;
+                pool.submit(queue, 0);
+                // batches created after the submit may move the submitted ones
+                for (GLuint texture = 1; texture < 64; ++texture) {
+                    auto other = config;
+                    other.textureId = texture;
+                    pool.getKey(other);
+                }
+                State::global().resetCounters();
+                queue.flush();
+                EXPECT_EQ(State::global().getDrawCount(), 1u);
+                EXPECT_EQ(State::global().getPrimitiveCount(), 2u);
+
+                Storage<VertexLayout>::global()->clear();
+            }
+
+        }
+    }
+}
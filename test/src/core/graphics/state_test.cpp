@@ -0,0 +1,89 @@
+#include "core/graphics/base.hpp"
+
+#include "core/graphics/state.hpp"
+
+namespace tme {
+    namespace core {
+        namespace graphics {
+
+            TEST_F(GraphicsTest, SkipRedundantBinds) {
+                State& state = State::global();
+                GLuint vertexArrays[2];
+                GLuint buffers[2];
+                glGenVertexArrays(2, vertexArrays);
+                glGenBuffers(2, buffers);
+
+                state.bindVertexArray(vertexArrays[0]);
+                state.resetCounters();
+                state.bindVertexArray(vertexArrays[0]);
+                state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+                state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+                EXPECT_EQ(state.getCallCount(), 1u);
+                EXPECT_EQ(state.getSkipCount(), 2u);
+
+                // the element array binding belongs to the vertex array
+                state.bindVertexArray(vertexArrays[1]);
+                state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[0]);
+                GLint bound;
+                glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &bound);
+                EXPECT_EQ(static_cast<GLuint>(bound), buffers[0]);
+                EXPECT_EQ(state.getCallCount(), 3u);
+
+                state.bindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+                state.bindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+                EXPECT_EQ(state.getCallCount(), 4u);
+
+                // deleting a buffer unbinds it
+                glDeleteBuffers(1, &buffers[1]);
+                state.forgetBuffer(buffers[1]);
+                glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &bound);
+                EXPECT_EQ(bound, 0);
+                state.bindBuffer(GL_ARRAY_BUFFER, 0);
+                EXPECT_EQ(state.getCallCount(), 4u);
+
+                state.bindVertexArray(0);
+                glDeleteVertexArrays(2, vertexArrays);
+                state.forgetVertexArray(vertexArrays[0]);
+                state.forgetVertexArray(vertexArrays[1]);
+                glDeleteBuffers(1, &buffers[0]);
+                state.forgetBuffer(buffers[0]);
+            }
+
+            TEST_F(GraphicsTest, SkipRedundantIndexedBinds) {
+                State& state = State::global();
+                GLuint buffer;
+                glGenBuffers(1, &buffer);
+
+                state.resetCounters();
+                state.bindBufferBase(GL_UNIFORM_BUFFER, 0, buffer);
+                state.bindBufferBase(GL_UNIFORM_BUFFER, 0, buffer);
+                EXPECT_EQ(state.getCallCount(), 1u);
+                EXPECT_EQ(state.getSkipCount(), 1u);
+
+                // the indexed bind binds the target as well
+                GLint bound;
+                glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &bound);
+                EXPECT_EQ(static_cast<GLuint>(bound), buffer);
+                state.bindBuffer(GL_UNIFORM_BUFFER, buffer);
+                EXPECT_EQ(state.getCallCount(), 1u);
+
+                glDeleteBuffers(1, &buffer);
+                state.forgetBuffer(buffer);
+                state.bindBufferBase(GL_UNIFORM_BUFFER, 0, 0);
+                EXPECT_EQ(state.getCallCount(), 1u);
+            }
+
+            TEST_F(GraphicsTest, SkipRedundantBlend) {
+                State& state = State::global();
+                state.setBlend(true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                state.resetCounters();
+                state.setBlend(true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                EXPECT_EQ(state.getCallCount(), 0u);
+                state.setBlend(false);
+                EXPECT_FALSE(glIsEnabled(GL_BLEND));
+                EXPECT_EQ(state.getCallCount(), 1u);
+            }
+
+        }
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "core/graphics/texture.hpp"
 #include "core/exceptions/input.hpp"
+#include <memory>
+#include <vector>
 
 namespace tme {
     namespace core {
@@ -21,6 +23,56 @@ namespace tme {
                 tex.unbind();
             }
 
+            TEST_F(GraphicsTest, TextureOptions) {
+                Texture tex(4, 4, {Texture::R8, true});
+                EXPECT_EQ(tex.getOptions().format, Texture::R8);
+                EXPECT_TRUE(tex.getOptions().mipmaps);
+                tex.bind();
+                GLint format, minFilter, levelWidth, swizzle[4];
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+                glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, 2, GL_TEXTURE_WIDTH, &levelWidth);
+                glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+                EXPECT_EQ(format, GL_R8);
+                EXPECT_EQ(minFilter, GL_LINEAR_MIPMAP_LINEAR);
+                EXPECT_EQ(levelWidth, 1);
+                // the red channel is sampled as opaque gray
+                EXPECT_EQ(swizzle[0], GL_RED);
+                EXPECT_EQ(swizzle[1], GL_RED);
+                EXPECT_EQ(swizzle[2], GL_RED);
+                EXPECT_EQ(swizzle[3], GL_ONE);
+                tex.unbind();
+            }
+
+            TEST_F(GraphicsTest, TextureSlots) {
+                GLint units;
+                glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &units);
+                std::vector<std::unique_ptr<Texture>> textures;
+                for (GLint i = 0; i <= units; ++i) {
+                    textures.emplace_back(new Texture(1, 1));
+                    textures.back()->bind();
+                    EXPECT_LT(textures.back()->getSlot(), static_cast<GLenum>(units));
+                }
+                // the first texture has been evicted by the last one
+                EXPECT_EQ(textures.back()->getSlot(), textures.front()->getSlot());
+                GLint bound;
+                glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+                EXPECT_EQ(static_cast<GLuint>(bound), textures.back()->getId());
+
+                // binding a resident texture keeps its slot
+                textures[1]->bind();
+                GLenum slot = textures[1]->getSlot();
+                textures[2]->bind();
+                textures[1]->bind();
+                EXPECT_EQ(textures[1]->getSlot(), slot);
+                glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+                EXPECT_EQ(static_cast<GLuint>(bound), textures[1]->getId());
+
+                textures.front()->bind();
+                glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+                EXPECT_EQ(static_cast<GLuint>(bound), textures.front()->getId());
+            }
+
             TEST_F(GraphicsTest, LoadInvalidTexture) {
                 const char* path = "../test/res/doesnotexist.png";
                 ASSERT_THROW(Texture tex(path), exceptions::InvalidInput);
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+#include <thread>
+#include "core/queue.hpp"
+
+namespace tme {
+    namespace core {
+
+        TEST(TestSpscQueue, PushAndPopInOrder) {
+            SpscQueue<int> queue(3);
+            EXPECT_TRUE(queue.empty());
+            EXPECT_EQ(3u, queue.getCapacity());
+
+            for (int i = 0; i < 3; ++i) {
+                EXPECT_TRUE(queue.push(i));
+            }
+            int value = 3;
+            EXPECT_FALSE(queue.push(value));
+            EXPECT_EQ(3, value);
+
+            for (int i = 0; i < 3; ++i) {
+                EXPECT_TRUE(queue.pop(value));
+                EXPECT_EQ(i, value);
+            }
+            EXPECT_FALSE(queue.pop(value));
+            EXPECT_TRUE(queue.empty());
+        }
+
+        TEST(TestSpscQueue, MoveOnlyElements) {
+            SpscQueue<std::unique_ptr<int>> queue(2);
+            auto element = std::make_unique<int>(42);
+            EXPECT_TRUE(queue.push(element));
+            EXPECT_EQ(nullptr, element);
+
+            std::unique_ptr<int> result;
+            EXPECT_TRUE(queue.pop(result));
+            ASSERT_NE(nullptr, result);
+            EXPECT_EQ(42, *result);
+        }
+
+        TEST(TestSpscQueue, TransferBetweenThreads) {
+            constexpr int count = 100000;
+            SpscQueue<int> queue(16);
+            std::thread producer([&queue]() {
+                for (int i = 0; i < count; ++i) {
+                    int value = i;
+                    while (!queue.push(value)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+
+            int expected = 0;
+            while (expected < count) {
+                int value;
+                if (queue.pop(value)) {
+                    EXPECT_EQ(expected, value);
+                    ++expected;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            producer.join();
+            EXPECT_TRUE(queue.empty());
+        }
+
+    }
+}
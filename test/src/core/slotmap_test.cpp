@@ -0,0 +1,123 @@
+#include <stdexcept>
+#include <string>
+#include "gtest/gtest.h"
+#include "core/slotmap.hpp"
+
+namespace tme {
+    namespace core {
+
+        TEST(TestSlotMap, InsertAndGet) {
+            SlotMap<std::string> slotMap;
+            auto first = slotMap.insert("first");
+            auto second = slotMap.emplace(3, 'x');
+
+            EXPECT_NE(first, second);
+            EXPECT_EQ(slotMap.size(), 2);
+            ASSERT_NE(slotMap.get(first), nullptr);
+            ASSERT_NE(slotMap.get(second), nullptr);
+            EXPECT_EQ(*slotMap.get(first), "first");
+            EXPECT_EQ(*slotMap.get(second), "xxx");
+            EXPECT_FALSE(slotMap.has(SlotMap<std::string>::Key()));
+        }
+
+        TEST(TestSlotMap, EraseKeepsOtherKeys) {
+            SlotMap<int> slotMap;
+            auto first = slotMap.insert(1);
+            auto second = slotMap.insert(2);
+            auto third = slotMap.insert(3);
+
+            EXPECT_TRUE(slotMap.erase(first));
+            EXPECT_FALSE(slotMap.erase(first));
+            EXPECT_FALSE(slotMap.has(first));
+            EXPECT_EQ(slotMap.get(first), nullptr);
+            // the last element moved into the gap, its key still refers to it
+            EXPECT_EQ(*slotMap.get(second), 2);
+            EXPECT_EQ(*slotMap.get(third), 3);
+            EXPECT_EQ(slotMap.size(), 2);
+        }
+
+        TEST(TestSlotMap, DetectStaleKeys) {
+            SlotMap<int> slotMap;
+            auto erased = slotMap.insert(1);
+            slotMap.erase(erased);
+            // reuses the slot of the erased element with a new generation
+            auto reused = slotMap.insert(2);
+
+            EXPECT_EQ(erased.index, reused.index);
+            EXPECT_NE(erased, reused);
+            EXPECT_FALSE(slotMap.has(erased));
+            EXPECT_EQ(slotMap.get(erased), nullptr);
+            EXPECT_EQ(*slotMap.get(reused), 2);
+        }
+
+        TEST(TestSlotMap, DenseIteration) {
+            SlotMap<int> slotMap;
+            EXPECT_EQ(slotMap.begin(), slotMap.end());
+            for (int i = 0; i < 5; ++i) {
+                slotMap.insert(i);
+            }
+            // erase all odd elements found while iterating
+            for (size_t i = 0; i < slotMap.size();) {
+                if (*(slotMap.begin() + static_cast<long>(i)) % 2) {
+                    slotMap.erase(slotMap.getKey(i));
+                } else {
+                    ++i;
+                }
+            }
+
+            int sum = 0;
+            for (int value : slotMap) {
+                EXPECT_EQ(value % 2, 0);
+                sum += value;
+            }
+            EXPECT_EQ(sum, 6);
+            EXPECT_EQ(slotMap.end() - slotMap.begin(), 3);
+        }
+
+        TEST(TestSlotMap, ClearSlotMap) {
+            SlotMap<int> slotMap;
+            auto first = slotMap.insert(1);
+            auto second = slotMap.insert(2);
+
+            slotMap.clear();
+            EXPECT_TRUE(slotMap.empty());
+            EXPECT_FALSE(slotMap.has(first));
+            EXPECT_FALSE(slotMap.has(second));
+
+            auto inserted = slotMap.insert(3);
+            EXPECT_NE(inserted, first);
+            EXPECT_NE(inserted, second);
+            EXPECT_EQ(*slotMap.get(inserted), 3);
+        }
+
+        TEST(TestSlotMap, FailedEmplace) {
+            struct Positive {
+                int value;
+                explicit Positive(int number) : value(number) {
+                    if (number <= 0) {
+                        throw std::invalid_argument("not positive");
+                    }
+                }
+            };
+            SlotMap<Positive> slotMap;
+            auto first = slotMap.emplace(1);
+            auto erased = slotMap.emplace(2);
+            slotMap.erase(erased);
+
+            // neither a free nor a new slot is taken by the failed element
+            EXPECT_THROW(slotMap.emplace(0), std::invalid_argument);
+            auto reused = slotMap.emplace(3);
+            EXPECT_EQ(reused.index, erased.index);
+            EXPECT_THROW(slotMap.emplace(-1), std::invalid_argument);
+            auto added = slotMap.emplace(4);
+
+            EXPECT_EQ(slotMap.size(), 3);
+            EXPECT_EQ(slotMap.getKey(2), added);
+            // erasing moves the last element, which has to be owned by its slot
+            slotMap.erase(first);
+            EXPECT_EQ(slotMap.get(added)->value, 4);
+            EXPECT_EQ(slotMap.get(reused)->value, 3);
+        }
+
+    }
+}
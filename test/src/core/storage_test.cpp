@@ -42,6 +42,24 @@ namespace tme {
             EXPECT_NE(added.get(), Storage<_ExampleClass>::global()->get(added->getId()).get());
         }
 
+        class _ExplicitIdClass : public Mappable {
+            Identifier m_id;
+
+            public:
+            _ExplicitIdClass(Identifier id) : m_id(id) {}
+            Identifier getId() const override { return m_id; }
+        };
+
+        TEST(TestStorage, WideIdentifiers) {
+            auto storage = Storage<_ExplicitIdClass>::localInstance();
+            // ids only differing above 32 bits must not collide
+            auto low = storage->create(1);
+            auto high = storage->create((Identifier(1) << 32) | 1);
+
+            EXPECT_EQ(low.get(), storage->get(1).get());
+            EXPECT_EQ(high.get(), storage->get((Identifier(1) << 32) | 1).get());
+        }
+
         TEST(TestStorage, CreateInLocal) {
             // creating two seperate storages and check that elements are available in the respective storages
             auto createdStorage = Storage<_ExampleClass>::localInstance();
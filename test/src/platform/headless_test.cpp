@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "sigcounter.hpp"
+#include "core/window.hpp"
+#include "platform/headless.hpp"
+#include "core/events/handler.hpp"
+
+namespace tme {
+    namespace platform {
+
+        class _BlankHandler : public core::events::Handler {
+            public:
+            void onEvent(core::events::Event&) override {}
+        };
+
+        TEST(HeadlessWindowTest, CreationAndDestruction) {
+            int assertCountBefore = SignalCounter::instance()->get(SignalCounter::assertionFailed);
+            auto context = Context::create();
+            _BlankHandler bh;
+            // tests static create method implementation in header
+            auto hw = core::Window::create({&bh, "test title", 220, 144});
+            hw->update();
+            hw->setTitle("other title");
+            hw->setVSync(!hw->isVSync());
+            hw->swapBuffer();
+            hw->pollEvents();
+            // cleanup as this pointer owns;
+            delete hw;
+            // should not cause any assert errors
+            EXPECT_EQ(SignalCounter::instance()->get(SignalCounter::assertionFailed), assertCountBefore);
+        }
+
+        TEST(HeadlessWindowTest, CreationWithoutContext) {
+            // triggers an assert failure which is checked
+            _BlankHandler bh;
+            int assertCountBefore = SignalCounter::instance()->get(SignalCounter::assertionFailed);
+            auto hw = core::Window::create({&bh, "test title", 220, 144});
+            EXPECT_EQ(SignalCounter::instance()->get(SignalCounter::assertionFailed), assertCountBefore + 1);
+            delete hw;
+        }
+
+        TEST(HeadlessWindowTest, ReadPixels) {
+            auto context = Context::create();
+            _BlankHandler bh;
+            std::unique_ptr<HeadlessWindow> hw(static_cast<HeadlessWindow*>(core::Window::create({&bh, "test title", 4, 2})));
+            glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            std::vector<unsigned char> pixels(4 * 2 * 4, 0);
+            hw->readPixels(pixels.data());
+            for (size_t i = 0; i < pixels.size(); i += 4) {
+                EXPECT_EQ(pixels[i], 255);
+                EXPECT_EQ(pixels[i + 1], 0);
+                EXPECT_EQ(pixels[i + 2], 0);
+                EXPECT_EQ(pixels[i + 3], 255);
+            }
+        }
+
+    }
+}